@@ -0,0 +1,343 @@
+/**
+ * @file
+ * bench_windowed_event_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Measures the cost of adding and counting events.
+ *
+ * Each case drives a counter with a stream of event times and reports the
+ * throughput of the whole stream along with latency percentiles of single
+ * calls.  Cases sweep buffer capacity, window length, event spacing and the
+ * pattern of the stream:
+ *   - steady: one event every gap
+ *   - burst: burst events at once, then a quiet spell of the same average rate
+ *   - idle: burst events every gap, then idle for twice the window so the next
+ *     call expires every stored event
+ *
+ * Usage: bench_windowed_event_counter [-n steps] [--json]
+ * Results are written to stdout as CSV, or JSON with --json.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "windowed_event_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//
+// Section: Constants
+//
+
+/// Default number of events driven through each case
+#define BENCH_STEPS_DEFAULT (200000U)
+
+/// Events per burst in the burst and idle patterns
+#define BENCH_BURST (64U)
+
+//
+// Section: Data Types
+//
+
+typedef enum {
+    BENCH_STEADY,
+    BENCH_BURST_PATTERN,
+    BENCH_IDLE,
+} BenchPattern_T;
+
+typedef struct {
+    BenchPattern_T pattern;
+    size_t capacity;
+    WEC_TIME_T windowLimit;
+    WEC_TIME_T gap;
+} BenchCase_T;
+
+typedef struct {
+    double nsPerOp;
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+} BenchResult_T;
+
+//
+// Section: Global Variable Declarations
+//
+
+static const char *const patternNames[] = {"steady", "burst", "idle"};
+
+static const size_t capacities[] = {32U, 256U, 4096U, 65536U};
+
+static const WEC_TIME_T windowLimits[] = {1000U, 100000U};
+
+static const WEC_TIME_T gaps[] = {1U, 10U};
+
+/// Event times of the current case
+static WEC_TIME_T *times;
+
+/// Latency of each add and count call of the current case
+static uint32_t *addSamples;
+static uint32_t *countSamples;
+
+/// Cost of reading the clock twice, removed from every sample
+static uint32_t clockOverhead;
+
+//
+// Section: Static Function Definitions
+//
+
+static uint64_t BenchNow(void) {
+    struct timespec now;
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000U) + (uint64_t) now.tv_nsec;
+}
+
+static int BenchSampleCompare(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *) a;
+    uint32_t right = *(const uint32_t *) b;
+    return (left > right) - (left < right);
+}
+
+static uint32_t BenchElapsed(uint64_t start, uint64_t stop) {
+    uint64_t elapsed = stop - start;
+    elapsed = (elapsed > clockOverhead) ? (elapsed - clockOverhead) : 0U;
+    return (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t) elapsed;
+}
+
+static void BenchClockCalibrate(void) {
+    uint32_t samples[1001];
+    clockOverhead = 0U;
+    for (size_t i = 0U; i < 1001U; i++) {
+        uint64_t start = BenchNow();
+        samples[i] = BenchElapsed(start, BenchNow());
+    }
+    qsort(samples, 1001U, sizeof (samples[0]), BenchSampleCompare);
+    clockOverhead = samples[500];
+}
+
+static void BenchTimesGenerate(const BenchCase_T *benchCase, size_t steps) {
+    WEC_TIME_T time = 0U;
+    for (size_t i = 0U; i < steps; i++) {
+        times[i] = time;
+        switch (benchCase->pattern) {
+            case BENCH_STEADY:
+                time += benchCase->gap;
+                break;
+            case BENCH_BURST_PATTERN:
+                if ((BENCH_BURST - 1U) == (i % BENCH_BURST)) {
+                    time += benchCase->gap * BENCH_BURST;
+                }
+                break;
+            case BENCH_IDLE:
+                time += benchCase->gap;
+                if ((BENCH_BURST - 1U) == (i % BENCH_BURST)) {
+                    time += 2U * benchCase->windowLimit;
+                }
+                break;
+        }
+    }
+}
+
+static void BenchCounterStart(WEC_Counter_T *counter, WEC_TIME_T buffer[],
+        const BenchCase_T *benchCase) {
+    (void) WEC_CounterInit(counter, buffer, benchCase->capacity);
+    (void) WEC_CounterWindowLimitSet(counter, benchCase->windowLimit);
+    (void) WEC_CounterWindowStart(counter, 0U);
+}
+
+static void BenchPercentiles(uint32_t samples[], size_t steps,
+        BenchResult_T *result) {
+    qsort(samples, steps, sizeof (samples[0]), BenchSampleCompare);
+    result->p50 = samples[(steps * 50U) / 100U];
+    result->p99 = samples[(steps * 99U) / 100U];
+    result->p999 = samples[(steps * 999U) / 1000U];
+    result->max = samples[steps - 1U];
+}
+
+static void BenchCaseRun(const BenchCase_T *benchCase, WEC_TIME_T buffer[],
+        size_t steps, BenchResult_T *add, BenchResult_T *count) {
+    WEC_Counter_T counter;
+    volatile WEC_COUNT_T sink = 0U;
+
+    BenchTimesGenerate(benchCase, steps);
+
+    // Throughput of the whole stream, adding alone and then adding and
+    // counting, so the cost of counting is the difference
+    BenchCounterStart(&counter, buffer, benchCase);
+    uint64_t start = BenchNow();
+    for (size_t i = 0U; i < steps; i++) {
+        (void) WEC_CounterEventAdd(&counter, times[i]);
+    }
+    uint64_t addTime = BenchNow() - start;
+
+    BenchCounterStart(&counter, buffer, benchCase);
+    start = BenchNow();
+    for (size_t i = 0U; i < steps; i++) {
+        (void) WEC_CounterEventAdd(&counter, times[i]);
+        sink = WEC_CounterEventCountGet(&counter, times[i]);
+    }
+    uint64_t addCountTime = BenchNow() - start;
+
+    add->nsPerOp = (double) addTime / (double) steps;
+    count->nsPerOp = (addCountTime > addTime)
+            ? ((double) (addCountTime - addTime) / (double) steps) : 0.0;
+
+    // Latency of single calls
+    BenchCounterStart(&counter, buffer, benchCase);
+    for (size_t i = 0U; i < steps; i++) {
+        start = BenchNow();
+        (void) WEC_CounterEventAdd(&counter, times[i]);
+        uint64_t middle = BenchNow();
+        sink = WEC_CounterEventCountGet(&counter, times[i]);
+        uint64_t stop = BenchNow();
+        addSamples[i] = BenchElapsed(start, middle);
+        countSamples[i] = BenchElapsed(middle, stop);
+    }
+    (void) sink;
+
+    BenchPercentiles(addSamples, steps, add);
+    BenchPercentiles(countSamples, steps, count);
+}
+
+static void BenchResultPrint(const BenchCase_T *benchCase,
+        const char *operation, const BenchResult_T *result, bool json,
+        bool first) {
+    if (json) {
+        printf("%s\n  {\"scenario\": \"%s\", \"operation\": \"%s\", "
+                "\"capacity\": %zu, \"window\": %lu, \"gap\": %lu, "
+                "\"ns_per_op\": %.2f, \"p50_ns\": %u, \"p99_ns\": %u, "
+                "\"p999_ns\": %u, \"max_ns\": %u}",
+                first ? "" : ",", patternNames[benchCase->pattern], operation,
+                benchCase->capacity, (unsigned long) benchCase->windowLimit,
+                (unsigned long) benchCase->gap, result->nsPerOp, result->p50,
+                result->p99, result->p999, result->max);
+    } else {
+        printf("%s,%s,%zu,%lu,%lu,%.2f,%u,%u,%u,%u\n",
+                patternNames[benchCase->pattern], operation,
+                benchCase->capacity, (unsigned long) benchCase->windowLimit,
+                (unsigned long) benchCase->gap, result->nsPerOp, result->p50,
+                result->p99, result->p999, result->max);
+    }
+}
+
+//
+// Section: Main
+//
+
+int main(int argc, char *argv[]) {
+    size_t steps = BENCH_STEPS_DEFAULT;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "--json")) {
+            json = true;
+        } else if ((0 == strcmp(argv[i], "-n")) && ((i + 1) < argc)) {
+            steps = strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [-n steps] [--json]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (0U == steps) {
+        steps = 1U;
+    }
+
+    size_t capacityMax = capacities[(sizeof (capacities)
+            / sizeof (capacities[0])) - 1U];
+    WEC_TIME_T *buffer = malloc(capacityMax * sizeof (WEC_TIME_T));
+    times = malloc(steps * sizeof (WEC_TIME_T));
+    addSamples = malloc(steps * sizeof (uint32_t));
+    countSamples = malloc(steps * sizeof (uint32_t));
+    if ((NULL == buffer) || (NULL == times) || (NULL == addSamples)
+            || (NULL == countSamples)) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    BenchClockCalibrate();
+    if (json) {
+        printf("[");
+    } else {
+        printf("scenario,operation,capacity,window,gap,ns_per_op,p50_ns,"
+                "p99_ns,p999_ns,max_ns\n");
+    }
+
+    bool first = true;
+    for (size_t p = 0U; p < (sizeof (patternNames) / sizeof (patternNames[0]));
+            p++) {
+        for (size_t c = 0U; c < (sizeof (capacities) / sizeof (capacities[0]));
+                c++) {
+            for (size_t w = 0U;
+                    w < (sizeof (windowLimits) / sizeof (windowLimits[0]));
+                    w++) {
+                for (size_t g = 0U; g < (sizeof (gaps) / sizeof (gaps[0]));
+                        g++) {
+                    BenchCase_T benchCase = {
+                        .pattern = (BenchPattern_T) p,
+                        .capacity = capacities[c],
+                        .windowLimit = windowLimits[w],
+                        .gap = gaps[g],
+                    };
+                    WEC_Counter_T probe;
+                    if (WEC_OKAY != WEC_CounterInit(&probe, buffer,
+                            benchCase.capacity)) {
+                        continue; // Capacity does not fit WEC_COUNT_T
+                    }
+
+                    BenchResult_T add;
+                    BenchResult_T count;
+                    BenchCaseRun(&benchCase, buffer, steps, &add, &count);
+                    BenchResultPrint(&benchCase, "add", &add, json, first);
+                    BenchResultPrint(&benchCase, "count", &count, json, false);
+                    first = false;
+                }
+            }
+        }
+    }
+    if (json) {
+        printf("\n]\n");
+    }
+
+    free(countSamples);
+    free(addSamples);
+    free(times);
+    free(buffer);
+    return EXIT_SUCCESS;
+}
+
+//
+// End of File
+//
+
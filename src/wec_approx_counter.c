@@ -0,0 +1,299 @@
+/**
+ * @file
+ * wec_approx_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Approximately counts events within a window in time using an exponential
+ * histogram.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_approx_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+/// Number of events in each bucket of a level
+#define WEC_APPROX_BUCKET_SIZE(level) ((WEC_BUCKET_COUNT_T) 1U << (level))
+
+//
+// Section: Constants
+//
+
+/// Largest count an approximate counter can hold
+#define WEC_APPROX_COUNT_MAX (UINT32_MAX)
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Appends a bucket as the newest of a level
+STATIC void WEC_ApproxBucketPush(WEC_ApproxCounter_T *counter, uint8_t level,
+        WEC_TIME_T bucketTime);
+
+/// Removes the oldest bucket of a level and returns its time
+STATIC WEC_TIME_T WEC_ApproxBucketPop(WEC_ApproxCounter_T *counter,
+        uint8_t level);
+
+/// Gets the time of the oldest bucket of a level
+STATIC WEC_TIME_T WEC_ApproxBucketOldestGet(const WEC_ApproxCounter_T *counter,
+        uint8_t level);
+
+/// Drops buckets whose newest event has left the window
+STATIC void WEC_ApproxBucketsExpire(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Updates the start time based on the window limit and current time
+STATIC WEC_TIME_T WEC_ApproxStartTimeUpdate(const WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Shifts the window start forward to currentTime and expires buckets
+STATIC WEC_ERROR_T WEC_ApproxWindowShift(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC void WEC_ApproxBucketPush(WEC_ApproxCounter_T *counter, uint8_t level,
+        WEC_TIME_T bucketTime) {
+    unsigned int slot = counter->oldest[level] + counter->buckets[level];
+    if (counter->levelCapacity <= slot) {
+        slot -= counter->levelCapacity;
+    }
+    counter->bucketTimes[(level * counter->levelCapacity) + slot] = bucketTime;
+    counter->buckets[level]++;
+}
+
+STATIC WEC_TIME_T WEC_ApproxBucketPop(WEC_ApproxCounter_T *counter,
+        uint8_t level) {
+    WEC_TIME_T bucketTime = WEC_ApproxBucketOldestGet(counter, level);
+    counter->oldest[level]++;
+    if (counter->levelCapacity <= counter->oldest[level]) {
+        counter->oldest[level] = 0U;
+    }
+    counter->buckets[level]--;
+    return bucketTime;
+}
+
+STATIC WEC_TIME_T WEC_ApproxBucketOldestGet(const WEC_ApproxCounter_T *counter,
+        uint8_t level) {
+    return counter->bucketTimes[(level * counter->levelCapacity)
+            + counter->oldest[level]];
+}
+
+STATIC void WEC_ApproxBucketsExpire(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    // Every bucket of a level is older than every bucket of the levels below,
+    // so expiry only walks down until it finds a bucket still in the window
+    uint8_t level = counter->levelCount;
+    while (0U < level) {
+        level--;
+        while (0U < counter->buckets[level]) {
+            WEC_TIME_T age = currentTime
+                    - WEC_ApproxBucketOldestGet(counter, level);
+            if (age < counter->windowLimit) {
+                return;
+            }
+            (void) WEC_ApproxBucketPop(counter, level);
+            counter->total -= WEC_APPROX_BUCKET_SIZE(level);
+        }
+    }
+}
+
+STATIC WEC_TIME_T WEC_ApproxStartTimeUpdate(const WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T newStart;
+    if ((WEC_TIME_T) (currentTime - counter->startTime)
+            >= counter->windowLimit) {
+        newStart = currentTime - counter->windowLimit;
+    } else {
+        newStart = counter->startTime;
+    }
+    return newStart;
+}
+
+STATIC WEC_ERROR_T WEC_ApproxWindowShift(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_ApproxStartTimeUpdate(counter, currentTime);
+        WEC_ApproxBucketsExpire(counter, currentTime);
+        return WEC_OKAY;
+    }
+    return WEC_NOT_STARTED;
+}
+
+//
+// Section: Approximate Counter APIs
+//
+
+WEC_ERROR_T WEC_ApproxCounterInit(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T bucketTimes[], size_t levelCount, uint8_t errorInverse) {
+    assert(NULL != counter);
+    if ((NULL == bucketTimes) || (0U == levelCount)
+            || (WEC_APPROX_LEVELS_MAX < levelCount) || (0U == errorInverse)) {
+        return WEC_ERROR;
+    }
+    counter->bucketTimes = bucketTimes;
+    counter->levelCount = (uint8_t) levelCount;
+    counter->levelCapacity = (uint8_t) WEC_APPROX_LEVEL_CAPACITY(errorInverse);
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->windowLimit = 0U;
+    counter->started = false;
+    WEC_ApproxCounterEventsClear(counter);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_ApproxCounterEventAdd(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (WEC_NOT_STARTED == WEC_ApproxWindowShift(counter, eventTime)) {
+        return WEC_NOT_STARTED;
+    }
+    if (WEC_APPROX_COUNT_MAX <= counter->total) {
+        return WEC_BUFFER_OVERFLOW;
+    }
+
+    WEC_ApproxBucketPush(counter, 0U, eventTime);
+    counter->total++;
+
+    // A full level merges its two oldest buckets into one of the next size,
+    // keeping the newer time.  Amortized over events this is O(1).
+    uint8_t level = 0U;
+    while (counter->levelCapacity == counter->buckets[level]) {
+        if ((level + 1U) == counter->levelCount) {
+            (void) WEC_ApproxBucketPop(counter, level);
+            counter->total -= WEC_APPROX_BUCKET_SIZE(level);
+            return WEC_BUFFER_OVERFLOW;
+        }
+        (void) WEC_ApproxBucketPop(counter, level);
+        WEC_ApproxBucketPush(counter, level + 1U,
+                WEC_ApproxBucketPop(counter, level));
+        level++;
+    }
+    return WEC_OKAY;
+}
+
+WEC_BUCKET_COUNT_T WEC_ApproxCounterEventCountGet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    (void) WEC_ApproxWindowShift(counter, currentTime);
+
+    // Assume half of the oldest bucket has left the window
+    uint8_t level = counter->levelCount;
+    while (0U < level) {
+        level--;
+        if (0U < counter->buckets[level]) {
+            return counter->total - (WEC_APPROX_BUCKET_SIZE(level) / 2U);
+        }
+    }
+    return 0U;
+}
+
+void WEC_ApproxCounterEventsClear(WEC_ApproxCounter_T *counter) {
+    for (uint8_t i = 0U; i < WEC_APPROX_LEVELS_MAX; i++) {
+        counter->oldest[i] = 0U;
+        counter->buckets[i] = 0U;
+    }
+    counter->total = 0U;
+}
+
+WEC_TIME_T WEC_ApproxCounterWindowLimitGet(const WEC_ApproxCounter_T *counter) {
+    return counter->windowLimit;
+}
+
+WEC_ERROR_T WEC_ApproxCounterWindowLimitSet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == counter->started) {
+        err = WEC_OKAY;
+        counter->windowLimit = windowLimit;
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_ApproxCounterWindowStart(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T startTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == counter->started) {
+        err = WEC_OKAY;
+        counter->started = true;
+        counter->startTime = startTime;
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_ApproxCounterWindowStop(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (true == counter->started) {
+        err = WEC_OKAY;
+        (void) WEC_ApproxWindowShift(counter, stopTime);
+        counter->started = false;
+        counter->stopTime = stopTime;
+    } else {
+        err = WEC_NOT_STARTED;
+    }
+    return err;
+}
+
+WEC_TIME_T WEC_ApproxCounterWindowTimeGet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T windowTime;
+    if (counter->started) {
+        counter->startTime = WEC_ApproxStartTimeUpdate(counter, currentTime);
+        windowTime = currentTime - counter->startTime;
+    } else {
+        windowTime = counter->stopTime - counter->startTime;
+    }
+    return windowTime;
+}
+
+//
+// End of File
+//
+
@@ -0,0 +1,207 @@
+/**
+ * @file
+ * wec_approx_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Approximately counts events within a window in time using an exponential
+ * histogram.
+ *
+ * Events are merged into buckets whose sizes are powers of two, newest events
+ * in the smallest buckets.  Only the time of the newest event in each bucket is
+ * stored, so memory grows with the logarithm of the count instead of with the
+ * count.  The estimate is off by at most 1 / errorInverse of the true count,
+ * which comes from not knowing how much of the oldest bucket has left the
+ * window.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_APPROX_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_APPROX_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "wec_bucket_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Largest number of bucket sizes one counter can use.  Each level doubles the
+/// bucket size, so 32 levels can count every value of WEC_BUCKET_COUNT_T.
+#    ifndef WEC_APPROX_LEVELS_MAX
+#        define WEC_APPROX_LEVELS_MAX (32U)
+#    endif
+
+/// Number of bucket times stored per level for an error bound of
+/// 1 / errorInverse
+#    define WEC_APPROX_LEVEL_CAPACITY(errorInverse) \
+        ((((errorInverse) + 1U) / 2U) + 2U)
+
+//
+// Section: Data Types
+//
+
+/**
+ * Approximate windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_ApproxCounter* APIs.
+ */
+typedef struct {
+    /// Time of the newest event in each bucket, one row of levelCapacity
+    /// elements per level holding buckets of 2^level events
+    WEC_TIME_T *bucketTimes;
+    /// Sum of the sizes of all buckets
+    WEC_BUCKET_COUNT_T total;
+    /// Timestamp marking the start of the measurement window
+    WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// index of the oldest bucket in each level's row
+    uint8_t oldest[WEC_APPROX_LEVELS_MAX];
+    /// Number of buckets in each level
+    uint8_t buckets[WEC_APPROX_LEVELS_MAX];
+    /// Number of levels in bucketTimes
+    uint8_t levelCount;
+    /// Number of elements in each row of bucketTimes
+    uint8_t levelCapacity;
+    /// Indicates when window is started and running
+    bool started;
+} WEC_ApproxCounter_T;
+
+//
+// Section: Approximate Counter APIs
+//
+
+/**
+ * Initializes an approximate counter instance.
+ * The counter starts out stopped, empty and with a window limit of 0.  It can
+ * count up to about (errorInverse / 2 + 1) * (2^levelCount - 1) events in a
+ * window before overflowing.
+ * @param counter instance to initialize
+ * @param bucketTimes storage for bucket times with
+ * levelCount * WEC_APPROX_LEVEL_CAPACITY(errorInverse) elements, must outlive
+ * the counter
+ * @param levelCount number of bucket sizes, at most WEC_APPROX_LEVELS_MAX
+ * @param errorInverse bounds the relative error of counts to 1 / errorInverse
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage or error bound cannot be used.
+ */
+WEC_ERROR_T WEC_ApproxCounterInit(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T bucketTimes[], size_t levelCount, uint8_t errorInverse);
+
+/**
+ * Updates event count of a counter with a new event.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when the largest level was full and its oldest
+ * bucket was dropped.
+ */
+WEC_ERROR_T WEC_ApproxCounterEventAdd(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+/**
+ * Gets an estimate of the current number of events of a counter.
+ * Removes expired buckets and returns the estimated count of remaining events.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Estimated count of events
+ */
+WEC_BUCKET_COUNT_T WEC_ApproxCounterEventCountGet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events of a counter.
+ * @param counter instance to clear
+ */
+void WEC_ApproxCounterEventsClear(WEC_ApproxCounter_T *counter);
+
+/**
+ * Gets the value of the current window limit of a counter.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_ApproxCounterWindowLimitGet(const WEC_ApproxCounter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window of a counter.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @return error
+ */
+WEC_ERROR_T WEC_ApproxCounterWindowLimitSet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Starts measurement on a counter.
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_ApproxCounterWindowStart(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement on a counter.
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_ApproxCounterWindowStop(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window of a counter.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_ApproxCounterWindowTimeGet(WEC_ApproxCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+#endif // WEC_APPROX_COUNTER_H
+
+//
+// End of File
+//
+
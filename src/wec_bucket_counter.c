@@ -0,0 +1,282 @@
+/**
+ * @file
+ * wec_bucket_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Counts events within a window in time using fixed size time buckets.
+ *
+ * Each bucket covers windowLimit / WEC_BUCKET_RESOLUTION units of time.  As
+ * time moves forward the newest bucket index advances around a circular buffer
+ * of buckets, dropping the counts of buckets that have left the window.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_bucket_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Largest number of buckets stored, including the partially expired oldest
+/// bucket
+#define WEC_BUCKET_SLOTS (WEC_BUCKET_RESOLUTION + 1U)
+
+/// Largest count a bucket counter can hold
+#define WEC_BUCKET_COUNT_MAX (UINT32_MAX)
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Moves the newest bucket forward to the bucket covering currentTime
+STATIC void WEC_BucketAdvance(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Drops the oldest bucket once every event it can hold has left the window
+STATIC void WEC_BucketExpire(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Updates the start time based on the window limit and current time
+STATIC WEC_TIME_T WEC_BucketStartTimeUpdate(const WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Shifts the buckets and window start forward to currentTime
+STATIC WEC_ERROR_T WEC_BucketWindowShift(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC void WEC_BucketAdvance(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T elapsed = currentTime - counter->bucketStart;
+    if (elapsed < counter->bucketWidth) {
+        return;
+    }
+
+    WEC_TIME_T steps = elapsed / counter->bucketWidth;
+    WEC_TIME_T clears = (steps < counter->slots) ? steps : counter->slots;
+    while (clears--) {
+        counter->newest++;
+        if (counter->slots <= counter->newest) {
+            counter->newest = 0U;
+        }
+        counter->total -= counter->buckets[counter->newest];
+        counter->buckets[counter->newest] = 0U;
+    }
+    counter->bucketStart += steps * counter->bucketWidth;
+}
+
+STATIC void WEC_BucketExpire(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    uint16_t oldest = counter->newest + 1U;
+    if (counter->slots <= oldest) {
+        oldest = 0U;
+    }
+
+    // Age of the newest time the oldest bucket could have recorded.  The ring
+    // holds just enough buckets to cover the window, so every other bucket
+    // still has a time inside it.
+    WEC_TIME_T age = (WEC_TIME_T) ((currentTime - counter->bucketStart)
+            + ((WEC_TIME_T) (counter->slots - 2U) * counter->bucketWidth)
+            + 1U);
+    if (age >= counter->windowLimit) {
+        counter->total -= counter->buckets[oldest];
+        counter->buckets[oldest] = 0U;
+    }
+}
+
+STATIC WEC_TIME_T WEC_BucketStartTimeUpdate(const WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T newStart;
+    if ((WEC_TIME_T) (currentTime - counter->startTime)
+            >= counter->windowLimit) {
+        newStart = currentTime - counter->windowLimit;
+    } else {
+        newStart = counter->startTime;
+    }
+    return newStart;
+}
+
+STATIC WEC_ERROR_T WEC_BucketWindowShift(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_BucketStartTimeUpdate(counter, currentTime);
+        WEC_BucketAdvance(counter, currentTime);
+        WEC_BucketExpire(counter, currentTime);
+        return WEC_OKAY;
+    }
+    return WEC_NOT_STARTED;
+}
+
+//
+// Section: Bucket Counter APIs
+//
+
+void WEC_BucketCounterInit(WEC_BucketCounter_T *counter) {
+    assert(NULL != counter);
+    counter->bucketStart = 0U;
+    counter->bucketWidth = 1U;
+    counter->slots = 2U;
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->windowLimit = 0U;
+    counter->started = false;
+    WEC_BucketCounterEventsClear(counter);
+}
+
+WEC_ERROR_T WEC_BucketCounterEventAdd(WEC_BucketCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (WEC_NOT_STARTED == WEC_BucketWindowShift(counter, eventTime)) {
+        return WEC_NOT_STARTED;
+    }
+    if (WEC_BUCKET_COUNT_MAX <= counter->total) {
+        return WEC_BUFFER_OVERFLOW;
+    }
+    counter->buckets[counter->newest]++;
+    counter->total++;
+    return WEC_OKAY;
+}
+
+WEC_BUCKET_COUNT_T WEC_BucketCounterEventCountGet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    (void) WEC_BucketWindowShift(counter, currentTime);
+    return counter->total;
+}
+
+void WEC_BucketCounterEventsClear(WEC_BucketCounter_T *counter) {
+    for (uint16_t i = 0U; i < WEC_BUCKET_SLOTS; i++) {
+        counter->buckets[i] = 0U;
+    }
+    counter->total = 0U;
+    counter->newest = 0U;
+}
+
+WEC_TIME_T WEC_BucketCounterWindowLimitGet(const WEC_BucketCounter_T *counter) {
+    return counter->windowLimit;
+}
+
+WEC_ERROR_T WEC_BucketCounterWindowLimitSet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == counter->started) {
+        err = WEC_OKAY;
+        counter->windowLimit = windowLimit;
+        WEC_TIME_T width = windowLimit / WEC_BUCKET_RESOLUTION;
+        if ((width * WEC_BUCKET_RESOLUTION) < windowLimit) {
+            width++;
+        }
+        if (0U == width) {
+            width = 1U;
+        }
+
+        // Rounding the width up may leave fewer buckets than the resolution
+        WEC_TIME_T buckets = windowLimit / width;
+        if ((buckets * width) < windowLimit) {
+            buckets++;
+        }
+        if (0U == buckets) {
+            buckets = 1U;
+        }
+        uint16_t slots = (uint16_t) (buckets + 1U);
+        if ((width != counter->bucketWidth) || (slots != counter->slots)) {
+            WEC_BucketCounterEventsClear(counter);
+        }
+        counter->bucketWidth = width;
+        counter->slots = slots;
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_BucketCounterWindowStart(WEC_BucketCounter_T *counter,
+        WEC_TIME_T startTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == counter->started) {
+        err = WEC_OKAY;
+        counter->started = true;
+        counter->startTime = startTime;
+        if (0U == counter->total) {
+            counter->bucketStart = startTime;
+        }
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_BucketCounterWindowStop(WEC_BucketCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (true == counter->started) {
+        err = WEC_OKAY;
+        (void) WEC_BucketWindowShift(counter, stopTime);
+        counter->started = false;
+        counter->stopTime = stopTime;
+    } else {
+        err = WEC_NOT_STARTED;
+    }
+    return err;
+}
+
+WEC_TIME_T WEC_BucketCounterWindowTimeGet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T windowTime;
+    if (counter->started) {
+        counter->startTime = WEC_BucketStartTimeUpdate(counter, currentTime);
+        windowTime = currentTime - counter->startTime;
+    } else {
+        windowTime = counter->stopTime - counter->startTime;
+    }
+    return windowTime;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * wec_bucket_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Counts events within a window in time using fixed size time buckets.
+ *
+ * Splits the measurement window into WEC_BUCKET_RESOLUTION buckets, each
+ * holding the number of events that occurred during its slice of time.  Memory
+ * and expiry cost depend only on the number of buckets, never on the event
+ * rate, at the price of counting to within one bucket's worth of time.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_BUCKET_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_BUCKET_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdbool.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Number of buckets the measurement window is split into.
+/// More buckets give finer resolution at the cost of a larger footprint.
+#    ifndef WEC_BUCKET_RESOLUTION
+#        define WEC_BUCKET_RESOLUTION (16U)
+#    endif
+
+//
+// Section: Data Types
+//
+
+typedef uint32_t WEC_BUCKET_COUNT_T;
+
+/**
+ * Bucketed windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_BucketCounter* APIs.
+ */
+typedef struct {
+    /// Count of events in each bucket.  One bucket more than the resolution is
+    /// kept to hold the bucket that is partially outside of the window.
+    WEC_BUCKET_COUNT_T buckets[WEC_BUCKET_RESOLUTION + 1U];
+    /// Sum of all buckets
+    WEC_BUCKET_COUNT_T total;
+    /// Timestamp marking the start of the newest bucket
+    WEC_TIME_T bucketStart;
+    /// Length of time covered by each bucket
+    WEC_TIME_T bucketWidth;
+    /// Timestamp marking the start of the measurement window
+    WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// Number of buckets in use, including the partially expired one
+    uint16_t slots;
+    /// index of the newest bucket
+    uint16_t newest;
+    /// Indicates when window is started and running
+    bool started;
+} WEC_BucketCounter_T;
+
+//
+// Section: Bucket Counter APIs
+//
+
+/**
+ * Initializes a bucket counter instance.
+ * The counter starts out stopped, empty and with a window limit of 0.
+ * @param counter instance to initialize
+ */
+void WEC_BucketCounterInit(WEC_BucketCounter_T *counter);
+
+/**
+ * Adds an event to the bucket covering its time.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when the bucket total would overflow, the event
+ * is not counted.
+ */
+WEC_ERROR_T WEC_BucketCounterEventAdd(WEC_BucketCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+/**
+ * Gets the current number of events.
+ * Drops buckets that have left the window and returns the count of events in
+ * the remaining buckets.  Events in the oldest bucket are counted until the
+ * whole bucket has left the window.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Count of events
+ */
+WEC_BUCKET_COUNT_T WEC_BucketCounterEventCountGet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events.
+ * @param counter instance to clear
+ */
+void WEC_BucketCounterEventsClear(WEC_BucketCounter_T *counter);
+
+/**
+ * Gets the value of the current window limit.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_BucketCounterWindowLimitGet(const WEC_BucketCounter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window.
+ * The width of each bucket is the window limit divided by
+ * WEC_BUCKET_RESOLUTION, rounded up.  Events counted with a different bucket
+ * width are cleared.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @return error
+ */
+WEC_ERROR_T WEC_BucketCounterWindowLimitSet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Starts measurement
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_BucketCounterWindowStart(WEC_BucketCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_BucketCounterWindowStop(WEC_BucketCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_BucketCounterWindowTimeGet(WEC_BucketCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+#endif // WEC_BUCKET_COUNTER_H
+
+//
+// End of File
+//
+
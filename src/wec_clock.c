@@ -0,0 +1,327 @@
+/**
+ * @file
+ * wec_clock.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Sources of the current time for the ...Now() counter APIs.
+ *
+ * Every source counts nanoseconds of the monotonic clock and divides by the
+ * unit on each read.  Keeping nanoseconds until the last step lets the TSC
+ * scale stay accurate for units of any length, and wraps every source around
+ * the range of WEC_TIME_T the same way.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_clock.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+#include <time.h>
+#if defined(__x86_64__)
+#    include <cpuid.h>
+#    include <x86intrin.h>
+#endif
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Nanoseconds per second
+#define WEC_CLOCK_NS_PER_S (UINT64_C(1000000000))
+
+/// System clock read by coarse clocks
+#ifdef CLOCK_MONOTONIC_COARSE
+#    define WEC_CLOCK_COARSE_ID CLOCK_MONOTONIC_COARSE
+#else
+#    define WEC_CLOCK_COARSE_ID CLOCK_MONOTONIC
+#endif
+
+//
+// Section: Global Variable Declarations
+//
+
+/// Clock read by the ...Now() APIs of the default counter, NULL when none
+STATIC WEC_Clock_T *WEC_defaultClock = NULL;
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Reads a system clock in nanoseconds
+STATIC uint64_t WEC_ClockSystemNs(clockid_t id);
+
+/// Stores the monotonic time in a cached clock every period until stopped
+STATIC void *WEC_ClockTimerThread(void *clock);
+
+/// Checks for a time stamp counter that ticks at a constant rate
+STATIC bool WEC_ClockTscInvariant(void);
+
+/// Reads the time stamp counter
+STATIC uint64_t WEC_ClockTscRead(void);
+
+/// Gets the clock of a counter, NULL when none is set
+STATIC WEC_Clock_T *WEC_CounterClockGet(const WEC_Counter_T *counter);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC uint64_t WEC_ClockSystemNs(clockid_t id) {
+    struct timespec now;
+    (void) clock_gettime(id, &now);
+    return ((uint64_t) now.tv_sec * WEC_CLOCK_NS_PER_S)
+            + (uint64_t) now.tv_nsec;
+}
+
+STATIC void *WEC_ClockTimerThread(void *clock) {
+    WEC_Clock_T *cached = clock;
+    const struct timespec period = {
+        .tv_sec = (time_t) (cached->periodNs / WEC_CLOCK_NS_PER_S),
+        .tv_nsec = (long) (cached->periodNs % WEC_CLOCK_NS_PER_S),
+    };
+
+    while (atomic_load_explicit(&cached->running, memory_order_relaxed)) {
+        (void) nanosleep(&period, NULL);
+        atomic_store_explicit(&cached->time,
+                (WEC_TIME_T) (WEC_ClockSystemNs(CLOCK_MONOTONIC)
+                        / cached->unitNs), memory_order_relaxed);
+    }
+
+    return NULL;
+}
+
+STATIC bool WEC_ClockTscInvariant(void) {
+#if defined(__x86_64__)
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    // Advanced power management leaf, bit 8 of EDX flags the invariant TSC
+    if ((0 == __get_cpuid(0x80000000U, &eax, &ebx, &ecx, &edx))
+            || (eax < 0x80000007U)) {
+        return false;
+    }
+    (void) __get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx);
+    return 0U != (edx & (1U << 8));
+#else
+    return false;
+#endif
+}
+
+STATIC uint64_t WEC_ClockTscRead(void) {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+STATIC WEC_Clock_T *WEC_CounterClockGet(const WEC_Counter_T *counter) {
+    return (NULL != counter->extensions) ? counter->extensions->clock : NULL;
+}
+
+//
+// Section: API Functions
+//
+
+WEC_ERROR_T WEC_ClockCoarseInit(WEC_Clock_T *clock, uint64_t unitNs) {
+    assert(NULL != clock);
+    if (0U == unitNs) {
+        return WEC_ERROR;
+    }
+    clock->source = WEC_CLOCK_COARSE;
+    clock->unitNs = unitNs;
+    atomic_init(&clock->time, 0U);
+    atomic_init(&clock->running, false);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_ClockCachedInit(WEC_Clock_T *clock, uint64_t unitNs,
+        uint64_t periodNs) {
+    assert(NULL != clock);
+    if ((0U == unitNs) || (0U == periodNs)) {
+        return WEC_ERROR;
+    }
+    clock->source = WEC_CLOCK_CACHED;
+    clock->unitNs = unitNs;
+    clock->periodNs = periodNs;
+    atomic_init(&clock->time,
+            (WEC_TIME_T) (WEC_ClockSystemNs(CLOCK_MONOTONIC) / unitNs));
+    atomic_init(&clock->running, true);
+    if (0 != pthread_create(&clock->thread, NULL, WEC_ClockTimerThread,
+            clock)) {
+        atomic_store(&clock->running, false);
+        return WEC_ERROR;
+    }
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_ClockTscInit(WEC_Clock_T *clock, uint64_t unitNs) {
+    assert(NULL != clock);
+    if ((0U == unitNs) || (false == WEC_ClockTscInvariant())) {
+        return WEC_ERROR;
+    }
+    const struct timespec calibration = {
+        .tv_sec = (time_t) (WEC_CLOCK_CALIBRATION_NS / WEC_CLOCK_NS_PER_S),
+        .tv_nsec = (long) (WEC_CLOCK_CALIBRATION_NS % WEC_CLOCK_NS_PER_S),
+    };
+    uint64_t nsStart = WEC_ClockSystemNs(CLOCK_MONOTONIC);
+    uint64_t tscStart = WEC_ClockTscRead();
+    (void) nanosleep(&calibration, NULL);
+    uint64_t nsStop = WEC_ClockSystemNs(CLOCK_MONOTONIC);
+    uint64_t tscStop = WEC_ClockTscRead();
+    if (tscStop <= tscStart) {
+        return WEC_ERROR;
+    }
+
+    clock->source = WEC_CLOCK_TSC;
+    clock->unitNs = unitNs;
+    clock->tscBase = tscStop;
+    clock->nsBase = nsStop;
+    clock->nsPerTick = ((nsStop - nsStart) << 32) / (tscStop - tscStart);
+    atomic_init(&clock->time, 0U);
+    atomic_init(&clock->running, false);
+    return WEC_OKAY;
+}
+
+void WEC_ClockMockInit(WEC_Clock_T *clock, WEC_TIME_T startTime) {
+    assert(NULL != clock);
+    clock->source = WEC_CLOCK_MOCK;
+    clock->unitNs = 1U;
+    atomic_init(&clock->time, startTime);
+    atomic_init(&clock->running, false);
+}
+
+void WEC_ClockMockSet(WEC_Clock_T *clock, WEC_TIME_T time) {
+    assert(WEC_CLOCK_MOCK == clock->source);
+    atomic_store_explicit(&clock->time, time, memory_order_relaxed);
+}
+
+void WEC_ClockMockAdvance(WEC_Clock_T *clock, WEC_TIME_T elapsed) {
+    assert(WEC_CLOCK_MOCK == clock->source);
+    (void) atomic_fetch_add_explicit(&clock->time, elapsed,
+            memory_order_relaxed);
+}
+
+void WEC_ClockDeinit(WEC_Clock_T *clock) {
+    assert(NULL != clock);
+    if ((WEC_CLOCK_CACHED == clock->source)
+            && atomic_exchange(&clock->running, false)) {
+        (void) pthread_join(clock->thread, NULL);
+    }
+}
+
+WEC_TIME_T WEC_ClockNow(WEC_Clock_T *clock) {
+    uint64_t ns = 0U;
+
+    switch (clock->source) {
+        case WEC_CLOCK_COARSE:
+            ns = WEC_ClockSystemNs(WEC_CLOCK_COARSE_ID);
+            break;
+        case WEC_CLOCK_TSC:
+        {
+            // Ticks since calibration times the scale overflows 64 bits after
+            // a few seconds, so multiply the halves separately
+            uint64_t ticks = WEC_ClockTscRead() - clock->tscBase;
+            uint64_t ticksLow = ticks & UINT32_MAX;
+            ns = clock->nsBase + ((ticks >> 32) * clock->nsPerTick)
+                    + (ticksLow * (clock->nsPerTick >> 32))
+                    + ((ticksLow * (clock->nsPerTick & UINT32_MAX)) >> 32);
+            break;
+        }
+        case WEC_CLOCK_CACHED:
+        case WEC_CLOCK_MOCK:
+        default:
+            return atomic_load_explicit(&clock->time, memory_order_relaxed);
+    }
+
+    return (WEC_TIME_T) (ns / clock->unitNs);
+}
+
+WEC_ERROR_T WEC_EventAddNow(void) {
+    if (NULL == WEC_defaultClock) {
+        return WEC_ERROR;
+    }
+    return WEC_EventAdd(WEC_ClockNow(WEC_defaultClock));
+}
+
+WEC_COUNT_T WEC_EventCountGetNow(void) {
+    if (NULL == WEC_defaultClock) {
+        return 0U;
+    }
+    return WEC_EventCountGet(WEC_ClockNow(WEC_defaultClock));
+}
+
+void WEC_ClockSet(WEC_Clock_T *clock) {
+    WEC_defaultClock = clock;
+}
+
+WEC_ERROR_T WEC_CounterEventAddNow(WEC_Counter_T *counter) {
+    WEC_Clock_T *clock = WEC_CounterClockGet(counter);
+    if (NULL == clock) {
+        return WEC_ERROR;
+    }
+    return WEC_CounterEventAdd(counter, WEC_ClockNow(clock));
+}
+
+WEC_COUNT_T WEC_CounterEventCountGetNow(WEC_Counter_T *counter) {
+    WEC_Clock_T *clock = WEC_CounterClockGet(counter);
+    if (NULL == clock) {
+        return 0U;
+    }
+    return WEC_CounterEventCountGet(counter, WEC_ClockNow(clock));
+}
+
+WEC_ERROR_T WEC_CounterClockSet(WEC_Counter_T *counter, WEC_Clock_T *clock) {
+    if (NULL == counter->extensions) {
+        return WEC_ERROR;
+    }
+    counter->extensions->clock = clock;
+    return WEC_OKAY;
+}
+
+//
+// End of File
+//
+
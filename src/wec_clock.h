@@ -0,0 +1,266 @@
+/**
+ * @file
+ * wec_clock.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Sources of the current time for the ...Now() counter APIs.
+ *
+ * A clock reads the time in units of unitNs nanoseconds, so counters attached
+ * to it take event times without the caller reading a clock of its own.
+ * Sources trade accuracy for the cost of each read:
+ *   - coarse: the coarse monotonic clock of the system, updated every
+ *     scheduler tick and read without a system call
+ *   - cached: a time stored by a timer thread every period and read with a
+ *     single load
+ *   - TSC: the processor time stamp counter, scaled by a rate calibrated
+ *     against the monotonic clock at init
+ *   - mock: a time set by the caller, for tests
+ *
+ * The ...Now() counter APIs live here rather than in the counter module, so
+ * counters that never read a clock do not link this module or its thread
+ * library.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ * TSC - Time Stamp Counter
+ */
+
+#ifndef WEC_CLOCK_H    // Guards against multiple inclusion
+#    define WEC_CLOCK_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <pthread.h>
+#    include <stdatomic.h>
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Time the TSC rate is measured over at init, in nanoseconds
+#    ifndef WEC_CLOCK_CALIBRATION_NS
+#        define WEC_CLOCK_CALIBRATION_NS (10000000U)
+#    endif
+
+//
+// Section: Data Types
+//
+
+/// Where a clock reads the time from
+typedef enum {
+    /// Coarse monotonic clock of the system
+    WEC_CLOCK_COARSE,
+    /// Time stored by a timer thread
+    WEC_CLOCK_CACHED,
+    /// Calibrated processor time stamp counter
+    WEC_CLOCK_TSC,
+    /// Time set by the caller
+    WEC_CLOCK_MOCK,
+} WEC_CLOCK_SOURCE_T;
+
+/**
+ * Clock instance.
+ * Treat the members as private and operate on them through the WEC_Clock*
+ * APIs.
+ */
+struct WEC_Clock_S {
+    /// Where the time is read from
+    WEC_CLOCK_SOURCE_T source;
+    /// Length of one unit of WEC_TIME_T in nanoseconds
+    uint64_t unitNs;
+    /// Latest time stored by the timer thread, or the time of a mock clock
+    _Atomic WEC_TIME_T time;
+    /// Cleared to stop the timer thread
+    atomic_bool running;
+    /// Timer thread of a cached clock
+    pthread_t thread;
+    /// Time between updates of a cached clock in nanoseconds
+    uint64_t periodNs;
+    /// TSC reading at calibration
+    uint64_t tscBase;
+    /// Monotonic time at calibration in nanoseconds
+    uint64_t nsBase;
+    /// Nanoseconds per TSC tick, scaled by 2 to the 32
+    uint64_t nsPerTick;
+};
+
+//
+// Section: APIs
+//
+
+/**
+ * Initializes a clock reading the coarse monotonic clock of the system.
+ * Falls back to the full resolution monotonic clock where there is no coarse
+ * one.
+ * @param clock instance to initialize
+ * @param unitNs length of one unit of time in nanoseconds
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when unitNs is 0.
+ */
+WEC_ERROR_T WEC_ClockCoarseInit(WEC_Clock_T *clock, uint64_t unitNs);
+
+/**
+ * Initializes a clock reading a time stored by a timer thread.
+ * The time is stored before returning and then every period, so reads lag
+ * the monotonic clock by up to one period plus scheduling delay.  Call
+ * WEC_ClockDeinit() to stop the thread.
+ * @param clock instance to initialize
+ * @param unitNs length of one unit of time in nanoseconds
+ * @param periodNs time between updates in nanoseconds
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when unitNs or periodNs is 0 or the thread cannot be
+ * started.
+ */
+WEC_ERROR_T WEC_ClockCachedInit(WEC_Clock_T *clock, uint64_t unitNs,
+        uint64_t periodNs);
+
+/**
+ * Initializes a clock reading the processor time stamp counter.
+ * Blocks for WEC_CLOCK_CALIBRATION_NS while measuring the counter rate
+ * against the monotonic clock.  Reads match the monotonic clock up to the
+ * calibration error.  The counter must tick at a constant rate shared by
+ * every core.
+ * @param clock instance to initialize
+ * @param unitNs length of one unit of time in nanoseconds
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when unitNs is 0 or the processor has no invariant time
+ * stamp counter.
+ */
+WEC_ERROR_T WEC_ClockTscInit(WEC_Clock_T *clock, uint64_t unitNs);
+
+/**
+ * Initializes a clock reading a time set by the caller.
+ * @param clock instance to initialize
+ * @param startTime first time read
+ */
+void WEC_ClockMockInit(WEC_Clock_T *clock, WEC_TIME_T startTime);
+
+/**
+ * Sets the time read from a mock clock.
+ * @param clock instance initialized by WEC_ClockMockInit()
+ * @param time new time
+ */
+void WEC_ClockMockSet(WEC_Clock_T *clock, WEC_TIME_T time);
+
+/**
+ * Moves the time read from a mock clock forward.
+ * @param clock instance initialized by WEC_ClockMockInit()
+ * @param elapsed time to move forward by
+ */
+void WEC_ClockMockAdvance(WEC_Clock_T *clock, WEC_TIME_T elapsed);
+
+/**
+ * Releases a clock, stopping the timer thread of a cached clock.
+ * Detach the clock from every counter first.
+ * @param clock instance to release
+ */
+void WEC_ClockDeinit(WEC_Clock_T *clock);
+
+/**
+ * Reads the current time of a clock.
+ * Safe to call from any thread.
+ * @param clock instance to read
+ * @returns current time in units of unitNs, wrapping around at the range of
+ * WEC_TIME_T
+ */
+WEC_TIME_T WEC_ClockNow(WEC_Clock_T *clock);
+
+//
+// Section: Counter APIs
+//
+
+/**
+ * Updates event count with a new event detected now, reading the time from
+ * the clock set by WEC_ClockSet().
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ * @returns WEC_ERROR when no clock is set, nothing is added.
+ */
+WEC_ERROR_T WEC_EventAddNow(void);
+
+/**
+ * Gets the current number of events, reading the time from the clock set by
+ * WEC_ClockSet().
+ * @returns Count of events, or 0 when no clock is set
+ */
+WEC_COUNT_T WEC_EventCountGetNow(void);
+
+/**
+ * Sets the clock read by WEC_EventAddNow() and WEC_EventCountGetNow().
+ * The clock must count in the same units as the window limit and the times
+ * passed to the other APIs.
+ * @param clock initialized clock, must stay valid until replaced, or NULL to
+ * detach the clock
+ */
+void WEC_ClockSet(WEC_Clock_T *clock);
+
+/**
+ * Updates event count of a counter with a new event detected now.
+ * @param counter instance to update
+ * @returns error code
+ * @see WEC_EventAddNow
+ */
+WEC_ERROR_T WEC_CounterEventAddNow(WEC_Counter_T *counter);
+
+/**
+ * Gets the current number of events of a counter, reading the time from its
+ * clock.
+ * @param counter instance to query
+ * @returns Count of events, or 0 when no clock is set
+ * @see WEC_EventCountGetNow
+ */
+WEC_COUNT_T WEC_CounterEventCountGetNow(WEC_Counter_T *counter);
+
+/**
+ * Sets the clock read by the ...Now() APIs of a counter.
+ * @param counter instance to update, with extensions attached
+ * @param clock initialized clock, or NULL to detach the clock
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the counter has no extensions.
+ * @see WEC_ClockSet
+ * @see WEC_CounterExtensionsSet
+ */
+WEC_ERROR_T WEC_CounterClockSet(WEC_Counter_T *counter, WEC_Clock_T *clock);
+
+#endif // WEC_CLOCK_H
+
+//
+// End of File
+//
+
@@ -0,0 +1,337 @@
+/**
+ * @file
+ * wec_compact_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Windowed event counter storing event times as 8 or 16 bit offsets.
+ *
+ * The window limit takes at most half of the offset range, so after expiry the
+ * offset of a new event only overflows once the base time lags the oldest
+ * event by half the range or more.  The base then moves up to the oldest
+ * event, rewriting the stored offsets, which happens at most once every half
+ * range of time.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_compact_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Largest count of events a counter can hold
+#define WEC_COMPACT_COUNT_MAX ((WEC_COUNT_T) ~(WEC_COUNT_T) 0)
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Picks the offset width for a window limit and divides storage into offsets
+STATIC WEC_ERROR_T WEC_CompactLayout(WEC_CompactCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/// Reads the offset stored at index
+STATIC WEC_TIME_T WEC_CompactOffsetGet(const WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index);
+
+/// Stores an offset at index
+STATIC void WEC_CompactOffsetSet(WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index, WEC_TIME_T offset);
+
+/// Advances indices around the circular buffer by up to a full lap
+STATIC WEC_COUNT_T WEC_CompactIndexAdvance(const WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index, WEC_COUNT_T steps);
+
+/// Moves the base time up to the oldest event, or to eventTime when empty
+STATIC void WEC_CompactRebase(WEC_CompactCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+/// Removes events equal to or older than the window limit in O(log n)
+STATIC void WEC_CompactExpire(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Updates the start time based on the window limit and current time
+STATIC WEC_TIME_T WEC_CompactStartTimeUpdate(
+        const WEC_CompactCounter_T *counter, WEC_TIME_T currentTime);
+
+/// Shifts the detection window forward to currentTime
+STATIC WEC_ERROR_T WEC_CompactWindowShift(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC WEC_ERROR_T WEC_CompactLayout(WEC_CompactCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    uint8_t offsetSize;
+    if ((0U == windowLimit) || (WEC_COMPACT_LIMIT_16 < windowLimit)) {
+        return WEC_ERROR;
+    } else if (WEC_COMPACT_LIMIT_8 >= windowLimit) {
+        offsetSize = sizeof (uint8_t);
+    } else {
+        offsetSize = sizeof (uint16_t);
+    }
+    size_t capacity = counter->storageSize / offsetSize;
+    if (0U == capacity) {
+        return WEC_ERROR;
+    }
+    if (WEC_COMPACT_COUNT_MAX < capacity) {
+        capacity = WEC_COMPACT_COUNT_MAX;
+    }
+    counter->offsetSize = offsetSize;
+    counter->capacity = (WEC_COUNT_T) capacity;
+    counter->windowLimit = windowLimit;
+    return WEC_OKAY;
+}
+
+STATIC WEC_TIME_T WEC_CompactOffsetGet(const WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index) {
+    if (sizeof (uint8_t) == counter->offsetSize) {
+        return counter->offsets.narrow[index];
+    }
+    return counter->offsets.wide[index];
+}
+
+STATIC void WEC_CompactOffsetSet(WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index, WEC_TIME_T offset) {
+    if (sizeof (uint8_t) == counter->offsetSize) {
+        counter->offsets.narrow[index] = (uint8_t) offset;
+    } else {
+        counter->offsets.wide[index] = (uint16_t) offset;
+    }
+}
+
+STATIC WEC_COUNT_T WEC_CompactIndexAdvance(const WEC_CompactCounter_T *counter,
+        WEC_COUNT_T index, WEC_COUNT_T steps) {
+    WEC_COUNT_T roomBeforeWrap = counter->capacity - index;
+    if (steps < roomBeforeWrap) {
+        return index + steps;
+    }
+    return steps - roomBeforeWrap;
+}
+
+STATIC void WEC_CompactRebase(WEC_CompactCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (0U == counter->count) {
+        counter->baseTime = eventTime;
+        return;
+    }
+    WEC_TIME_T shift = WEC_CompactOffsetGet(counter, counter->tail);
+    WEC_COUNT_T index = counter->tail;
+    for (WEC_COUNT_T i = 0U; i < counter->count; i++) {
+        WEC_CompactOffsetSet(counter, index,
+                WEC_CompactOffsetGet(counter, index) - shift);
+        index = WEC_CompactIndexAdvance(counter, index, 1U);
+    }
+    counter->baseTime += shift;
+}
+
+STATIC void WEC_CompactExpire(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    // Ages measured from the base are offsets, so an event is in the window
+    // when its offset is past the oldest offset still in the window.  Works
+    // out through wrap around since only differences are compared.
+    WEC_TIME_T age = currentTime - counter->baseTime;
+    if ((0U == counter->count) || ((WEC_TIME_T) (age
+            - WEC_CompactOffsetGet(counter, counter->tail))
+            < counter->windowLimit)) {
+        return; // Nothing to expire
+    }
+    WEC_COUNT_T low = 1U;
+    WEC_COUNT_T high = counter->count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T index = WEC_CompactIndexAdvance(counter, counter->tail,
+                mid);
+        if ((WEC_TIME_T) (age - WEC_CompactOffsetGet(counter, index))
+                < counter->windowLimit) {
+            high = mid;
+        } else {
+            low = mid + 1U;
+        }
+    }
+    counter->count -= low;
+    counter->tail = WEC_CompactIndexAdvance(counter, counter->tail, low);
+}
+
+STATIC WEC_TIME_T WEC_CompactStartTimeUpdate(
+        const WEC_CompactCounter_T *counter, WEC_TIME_T currentTime) {
+    if ((WEC_TIME_T) (currentTime - counter->startTime)
+            >= counter->windowLimit) {
+        return currentTime - counter->windowLimit;
+    }
+    return counter->startTime;
+}
+
+STATIC WEC_ERROR_T WEC_CompactWindowShift(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_CompactStartTimeUpdate(counter, currentTime);
+        WEC_CompactExpire(counter, currentTime);
+        return WEC_OKAY;
+    }
+    return WEC_NOT_STARTED;
+}
+
+//
+// Section: APIs
+//
+
+WEC_ERROR_T WEC_CompactCounterInit(WEC_CompactCounter_T *counter, void *storage,
+        size_t storageSize, WEC_TIME_T windowLimit) {
+    assert(NULL != counter);
+    if (NULL == storage) {
+        return WEC_ERROR;
+    }
+    counter->storage = storage;
+    counter->storageSize = storageSize;
+    counter->offsets.narrow = storage;
+    if (WEC_OKAY != WEC_CompactLayout(counter, windowLimit)) {
+        return WEC_ERROR;
+    }
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->started = false;
+    WEC_CompactCounterEventsClear(counter);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CompactCounterEventAdd(WEC_CompactCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (WEC_NOT_STARTED == WEC_CompactWindowShift(counter, eventTime)) {
+        return WEC_NOT_STARTED;
+    }
+    WEC_TIME_T offsetMax = (sizeof (uint8_t) == counter->offsetSize)
+            ? UINT8_MAX : UINT16_MAX;
+    WEC_TIME_T offset = eventTime - counter->baseTime;
+    if ((0U == counter->count) || (offsetMax < offset)) {
+        // Events left after expiry are less than the window limit older than
+        // eventTime, so the new offset fits once the base is the oldest event
+        WEC_CompactRebase(counter, eventTime);
+        offset = eventTime - counter->baseTime;
+    }
+
+    WEC_ERROR_T result = WEC_OKAY;
+    if (counter->capacity <= counter->count) {
+        counter->tail = WEC_CompactIndexAdvance(counter, counter->tail, 1U);
+        counter->count--;
+        result = WEC_BUFFER_OVERFLOW;
+    }
+    WEC_CompactOffsetSet(counter, counter->head, offset);
+    counter->head = WEC_CompactIndexAdvance(counter, counter->head, 1U);
+    counter->count++;
+    return result;
+}
+
+WEC_COUNT_T WEC_CompactCounterEventCountGet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    (void) WEC_CompactWindowShift(counter, currentTime);
+    return counter->count;
+}
+
+void WEC_CompactCounterEventsClear(WEC_CompactCounter_T *counter) {
+    counter->count = 0U;
+    counter->head = 0U;
+    counter->tail = 0U;
+    counter->baseTime = 0U;
+}
+
+WEC_COUNT_T WEC_CompactCounterCapacityGet(const WEC_CompactCounter_T *counter) {
+    return counter->capacity;
+}
+
+WEC_TIME_T WEC_CompactCounterWindowLimitGet(const WEC_CompactCounter_T *counter) {
+    return counter->windowLimit;
+}
+
+WEC_ERROR_T WEC_CompactCounterWindowLimitSet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    if (true == counter->started) {
+        return WEC_ALREADY_STARTED;
+    }
+    if (WEC_OKAY != WEC_CompactLayout(counter, windowLimit)) {
+        return WEC_ERROR;
+    }
+    WEC_CompactCounterEventsClear(counter);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CompactCounterWindowStart(WEC_CompactCounter_T *counter,
+        WEC_TIME_T startTime) {
+    if (true == counter->started) {
+        return WEC_ALREADY_STARTED;
+    }
+    counter->started = true;
+    counter->startTime = startTime;
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CompactCounterWindowStop(WEC_CompactCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    if (false == counter->started) {
+        return WEC_NOT_STARTED;
+    }
+    (void) WEC_CompactWindowShift(counter, stopTime);
+    counter->started = false;
+    counter->stopTime = stopTime;
+    return WEC_OKAY;
+}
+
+WEC_TIME_T WEC_CompactCounterWindowTimeGet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_CompactStartTimeUpdate(counter, currentTime);
+        return currentTime - counter->startTime;
+    }
+    return counter->stopTime - counter->startTime;
+}
+
+//
+// End of File
+//
+
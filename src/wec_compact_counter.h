@@ -0,0 +1,216 @@
+/**
+ * @file
+ * wec_compact_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Windowed event counter storing event times as 8 or 16 bit offsets.
+ *
+ * Every event still in the window is less than the window limit older than
+ * the newest, so its time fits in a small offset from a base time.  Storing
+ * offsets instead of full times packs two to four times the events into the
+ * same memory, and expiry searches touch that many fewer cache lines.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_COMPACT_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_COMPACT_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Longest window limit stored in 8 bit offsets
+#    define WEC_COMPACT_LIMIT_8 (UINT8_MAX / 2U + 1U)
+
+/// Longest window limit a compact counter supports, stored in 16 bit offsets
+#    define WEC_COMPACT_LIMIT_16 (UINT16_MAX / 2U + 1U)
+
+//
+// Section: Data Types
+//
+
+/**
+ * Compact windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_CompactCounter* APIs.
+ */
+typedef struct {
+    /// Caller storage for the offsets
+    void *storage;
+    /// Number of bytes in storage
+    size_t storageSize;
+    /// Stores the time of each event as an offset from baseTime
+    union {
+        uint8_t *narrow;
+        uint16_t *wide;
+    } offsets;
+    /// Bytes per offset, 1 or 2
+    uint8_t offsetSize;
+    /// Time the offsets are measured from, at or before the oldest event
+    WEC_TIME_T baseTime;
+    /// Timestamp marking the start of the measurement window
+    WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// current count of events
+    WEC_COUNT_T count;
+    /// Number of offsets held in storage
+    WEC_COUNT_T capacity;
+    /// index of the position to add the next event
+    WEC_COUNT_T head;
+    /// index of the oldest event
+    WEC_COUNT_T tail;
+    /// Indicates when window is started and running
+    bool started;
+} WEC_CompactCounter_T;
+
+//
+// Section: APIs
+//
+
+/**
+ * Initializes a compact counter storing events in caller supplied memory.
+ * Offsets are 8 bits wide for window limits up to WEC_COMPACT_LIMIT_8 and 16
+ * bits wide up to WEC_COMPACT_LIMIT_16.
+ * @param counter instance to initialize
+ * @param storage memory for the offsets, aligned for uint16_t, must outlive
+ * the counter
+ * @param storageSize number of bytes in storage.  Offsets beyond the largest
+ * WEC_COUNT_T are left unused.
+ * @param windowLimit maximum length of measurement window
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage cannot hold an offset or windowLimit is
+ * 0 or above WEC_COMPACT_LIMIT_16.
+ */
+WEC_ERROR_T WEC_CompactCounterInit(WEC_CompactCounter_T *counter, void *storage,
+        size_t storageSize, WEC_TIME_T windowLimit);
+
+/**
+ * Updates event count with a new event.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ */
+WEC_ERROR_T WEC_CompactCounterEventAdd(WEC_CompactCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+/**
+ * Gets the current number of events.
+ * Removes expired events and returns the count of remaining events.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Count of events
+ */
+WEC_COUNT_T WEC_CompactCounterEventCountGet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events.
+ * @param counter instance to clear
+ */
+void WEC_CompactCounterEventsClear(WEC_CompactCounter_T *counter);
+
+/**
+ * Gets the number of events the storage holds.
+ * @param counter instance to query
+ * @returns capacity, which depends on the offset width
+ */
+WEC_COUNT_T WEC_CompactCounterCapacityGet(const WEC_CompactCounter_T *counter);
+
+/**
+ * Gets the value of the current window limit.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_CompactCounterWindowLimitGet(const WEC_CompactCounter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window.
+ * Picks the offset width for the new limit and clears out all events.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ALREADY_STARTED when the window is started.
+ * @returns WEC_ERROR when windowLimit cannot be stored, nothing is changed.
+ */
+WEC_ERROR_T WEC_CompactCounterWindowLimitSet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Starts measurement
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_CompactCounterWindowStart(WEC_CompactCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_CompactCounterWindowStop(WEC_CompactCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_CompactCounterWindowTimeGet(WEC_CompactCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+#endif // WEC_COMPACT_COUNTER_H
+
+//
+// End of File
+//
+
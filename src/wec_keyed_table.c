@@ -0,0 +1,332 @@
+/**
+ * @file
+ * wec_keyed_table.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Table of windowed event counters, one per key.
+ *
+ * Uses linear probing with backward shift deletion, so evicting a key never
+ * leaves tombstones behind.  Each entry owns a slice of the event buffer, and
+ * entries swap slices when they are shifted so no events are ever copied.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_keyed_table.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Spreads the bits of a key over the whole hash
+STATIC size_t WEC_KeyHash(WEC_KEY_T key);
+
+/// Finds the entry of a key, or the empty entry where it would be added
+STATIC size_t WEC_KeyedSlotFind(const WEC_KeyedTable_T *table, WEC_KEY_T key);
+
+/// Removes a key, shifting back later keys of the same probe sequence
+STATIC void WEC_KeyedSlotRemove(WEC_KeyedTable_T *table, size_t slot);
+
+/// Gets the event ring of an entry
+STATIC WEC_TIME_T *WEC_KeyedRingGet(const WEC_KeyedTable_T *table,
+        const WEC_KeyedEntry_T *entry);
+
+/// Moves a ring index forward, wrapping at the key capacity
+STATIC WEC_COUNT_T WEC_KeyedIndexAdvance(const WEC_KeyedTable_T *table,
+        WEC_COUNT_T index, WEC_COUNT_T steps);
+
+/// Checks whether every event of an entry has left the window
+STATIC bool WEC_KeyedEntryExpired(const WEC_KeyedTable_T *table,
+        const WEC_KeyedEntry_T *entry, WEC_TIME_T currentTime);
+
+/// Removes events of an entry that have left the window in O(log n)
+STATIC void WEC_KeyedEntryExpire(const WEC_KeyedTable_T *table,
+        WEC_KeyedEntry_T *entry, WEC_TIME_T currentTime);
+
+/// Evicts expired keys on the probe chain of key, then along the sweep
+STATIC size_t WEC_KeyedEvict(WEC_KeyedTable_T *table, WEC_KEY_T key,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC size_t WEC_KeyHash(WEC_KEY_T key) {
+    // SplitMix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return (size_t) key;
+}
+
+STATIC size_t WEC_KeyedSlotFind(const WEC_KeyedTable_T *table, WEC_KEY_T key) {
+    size_t mask = table->entryCount - 1U;
+    size_t slot = WEC_KeyHash(key) & mask;
+    while (table->entries[slot].occupied
+            && (key != table->entries[slot].key)) {
+        slot = (slot + 1U) & mask;
+    }
+    return slot;
+}
+
+STATIC void WEC_KeyedSlotRemove(WEC_KeyedTable_T *table, size_t slot) {
+    size_t mask = table->entryCount - 1U;
+    size_t hole = slot;
+    size_t next = (hole + 1U) & mask;
+
+    table->entries[hole].tail = 0U;
+    table->entries[hole].count = 0U;
+    while (table->entries[next].occupied) {
+        size_t home = WEC_KeyHash(table->entries[next].key) & mask;
+        // The key may fill the hole unless its home lies after the hole
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            // The emptied ring moves along with the hole
+            WEC_KeyedEntry_T moved = table->entries[next];
+            table->entries[next] = table->entries[hole];
+            table->entries[hole] = moved;
+            hole = next;
+        }
+        next = (next + 1U) & mask;
+    }
+    table->entries[hole].occupied = false;
+    table->keyCount--;
+}
+
+STATIC WEC_TIME_T *WEC_KeyedRingGet(const WEC_KeyedTable_T *table,
+        const WEC_KeyedEntry_T *entry) {
+    return &table->eventPool[(size_t) entry->ring * table->keyCapacity];
+}
+
+STATIC WEC_COUNT_T WEC_KeyedIndexAdvance(const WEC_KeyedTable_T *table,
+        WEC_COUNT_T index, WEC_COUNT_T steps) {
+    // Both are below keyCapacity, so one subtraction wraps the sum
+    WEC_COUNT_T room = table->keyCapacity - index;
+    return (steps < room) ? (WEC_COUNT_T) (index + steps)
+            : (WEC_COUNT_T) (steps - room);
+}
+
+STATIC bool WEC_KeyedEntryExpired(const WEC_KeyedTable_T *table,
+        const WEC_KeyedEntry_T *entry, WEC_TIME_T currentTime) {
+    if (0U == entry->count) {
+        return true;
+    }
+    // Events are stored oldest first, so the newest one expires last
+    WEC_COUNT_T newest = WEC_KeyedIndexAdvance(table, entry->tail,
+            entry->count - 1U);
+    WEC_TIME_T age = currentTime - WEC_KeyedRingGet(table, entry)[newest];
+    return age >= table->windowLimit;
+}
+
+STATIC void WEC_KeyedEntryExpire(const WEC_KeyedTable_T *table,
+        WEC_KeyedEntry_T *entry, WEC_TIME_T currentTime) {
+    const WEC_TIME_T *events = WEC_KeyedRingGet(table, entry);
+    if ((0U == entry->count) || ((WEC_TIME_T) (currentTime
+            - events[entry->tail]) < table->windowLimit)) {
+        return; // Nothing to expire
+    }
+
+    // Ages only decrease from tail to head, so binary search for the first
+    // event still in the window
+    WEC_COUNT_T low = 1U;
+    WEC_COUNT_T high = entry->count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T index = WEC_KeyedIndexAdvance(table, entry->tail, mid);
+        if ((WEC_TIME_T) (currentTime - events[index]) < table->windowLimit) {
+            high = mid;
+        } else {
+            low = mid + 1U;
+        }
+    }
+    entry->tail = WEC_KeyedIndexAdvance(table, entry->tail, low);
+    entry->count -= low;
+}
+
+STATIC size_t WEC_KeyedEvict(WEC_KeyedTable_T *table, WEC_KEY_T key,
+        WEC_TIME_T currentTime) {
+    size_t mask = table->entryCount - 1U;
+    size_t evicted = 0U;
+
+    // The new key can only land on its own probe chain, which the load limit
+    // keeps short
+    size_t slot = WEC_KeyHash(key) & mask;
+    while (table->entries[slot].occupied) {
+        if (WEC_KeyedEntryExpired(table, &table->entries[slot], currentTime)) {
+            // A later key may shift into this slot, so check it again
+            WEC_KeyedSlotRemove(table, slot);
+            evicted++;
+        } else {
+            slot = (slot + 1U) & mask;
+        }
+    }
+    if (0U < evicted) {
+        return evicted;
+    }
+
+    // Otherwise look a little further each call, so that every expired key is
+    // found eventually without scanning the whole table at once
+    for (size_t checked = 0U; checked < WEC_KEYED_SWEEP_LENGTH; checked++) {
+        WEC_KeyedEntry_T *entry = &table->entries[table->sweep];
+        if (entry->occupied
+                && WEC_KeyedEntryExpired(table, entry, currentTime)) {
+            WEC_KeyedSlotRemove(table, table->sweep);
+            evicted++;
+        } else {
+            table->sweep = (table->sweep + 1U) & mask;
+        }
+    }
+    return evicted;
+}
+
+//
+// Section: Keyed Table APIs
+//
+
+WEC_ERROR_T WEC_KeyedTableInit(WEC_KeyedTable_T *table,
+        WEC_KeyedEntry_T entries[], size_t entryCount,
+        WEC_TIME_T eventBuffer[], size_t keyCapacity, WEC_TIME_T windowLimit) {
+    assert(NULL != table);
+    if ((NULL == entries) || (NULL == eventBuffer) || (2U > entryCount)
+            || (0U != (entryCount & (entryCount - 1U)))
+            || ((uint32_t) (entryCount - 1U) != (entryCount - 1U))
+            || (0U == keyCapacity)
+            || ((WEC_COUNT_T) keyCapacity != keyCapacity)) {
+        return WEC_ERROR;
+    }
+    for (size_t i = 0U; i < entryCount; i++) {
+        entries[i].key = 0U;
+        entries[i].ring = (uint32_t) i;
+        entries[i].tail = 0U;
+        entries[i].count = 0U;
+        entries[i].occupied = false;
+    }
+    table->entries = entries;
+    table->eventPool = eventBuffer;
+    table->entryCount = entryCount;
+    table->keyCount = 0U;
+    table->keyLimit = entryCount - (entryCount / 4U);
+    if (table->keyLimit == entryCount) {
+        table->keyLimit--; // Always leave an empty entry to end probing
+    }
+    table->sweep = 0U;
+    table->windowLimit = windowLimit;
+    table->keyCapacity = (WEC_COUNT_T) keyCapacity;
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_KeyedTableEventAdd(WEC_KeyedTable_T *table, WEC_KEY_T key,
+        WEC_TIME_T eventTime) {
+    size_t slot = WEC_KeyedSlotFind(table, key);
+    WEC_KeyedEntry_T *entry = &table->entries[slot];
+
+    if (false == entry->occupied) {
+        if (table->keyCount >= table->keyLimit) {
+            if (0U == WEC_KeyedEvict(table, key, eventTime)) {
+                return WEC_TABLE_FULL;
+            }
+            slot = WEC_KeyedSlotFind(table, key);
+            entry = &table->entries[slot];
+        }
+        entry->key = key;
+        entry->occupied = true;
+        table->keyCount++;
+    }
+
+    WEC_ERROR_T err = WEC_OKAY;
+    WEC_KeyedEntryExpire(table, entry, eventTime);
+    if (table->keyCapacity <= entry->count) {
+        // Buffer overflow, the oldest event makes room
+        entry->tail = WEC_KeyedIndexAdvance(table, entry->tail, 1U);
+        entry->count--;
+        err = WEC_BUFFER_OVERFLOW;
+    }
+    WEC_COUNT_T head = WEC_KeyedIndexAdvance(table, entry->tail, entry->count);
+    WEC_KeyedRingGet(table, entry)[head] = eventTime;
+    entry->count++;
+    return err;
+}
+
+WEC_COUNT_T WEC_KeyedTableEventCountGet(WEC_KeyedTable_T *table,
+        WEC_KEY_T key, WEC_TIME_T currentTime) {
+    size_t slot = WEC_KeyedSlotFind(table, key);
+    WEC_KeyedEntry_T *entry = &table->entries[slot];
+    if (false == entry->occupied) {
+        return 0U;
+    }
+    WEC_KeyedEntryExpire(table, entry, currentTime);
+    WEC_COUNT_T count = entry->count;
+    if (0U == count) {
+        WEC_KeyedSlotRemove(table, slot);
+    }
+    return count;
+}
+
+size_t WEC_KeyedTableExpire(WEC_KeyedTable_T *table, WEC_TIME_T currentTime) {
+    size_t evicted = 0U;
+    size_t slot = 0U;
+    while (slot < table->entryCount) {
+        WEC_KeyedEntry_T *entry = &table->entries[slot];
+        if (entry->occupied
+                && WEC_KeyedEntryExpired(table, entry, currentTime)) {
+            // A later key may shift into this slot, so check it again
+            WEC_KeyedSlotRemove(table, slot);
+            evicted++;
+        } else {
+            slot++;
+        }
+    }
+    return evicted;
+}
+
+size_t WEC_KeyedTableKeyCountGet(const WEC_KeyedTable_T *table) {
+    return table->keyCount;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * wec_keyed_table.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Table of windowed event counters, one per key.
+ *
+ * Tracks a separate window for each key, such as an IP address, API token or
+ * device ID.  Keys are stored in an open addressing hash table, each with its
+ * own windowed event counter.  Keys whose windows have fully expired are
+ * evicted, so the table only holds the keys that are currently active.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_KEYED_TABLE_H    // Guards against multiple inclusion
+#    define WEC_KEYED_TABLE_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Largest number of entries a full table checks for expired keys, past the
+/// probe chain of the new key, before it reports WEC_TABLE_FULL
+#    ifndef WEC_KEYED_SWEEP_LENGTH
+#        define WEC_KEYED_SWEEP_LENGTH (8U)
+#    endif
+
+//
+// Section: Data Types
+//
+
+typedef uint64_t WEC_KEY_T;
+
+/**
+ * Table entry holding the window of one key.
+ * Treat the members as private.
+ */
+typedef struct {
+    /// Key the entry belongs to
+    WEC_KEY_T key;
+    /// Index of the event ring the entry owns in the shared event pool.
+    /// Unused entries keep their ring.
+    uint32_t ring;
+    /// Index of the oldest event within the ring
+    WEC_COUNT_T tail;
+    /// Number of events in the ring
+    WEC_COUNT_T count;
+    /// Indicates when the entry holds a key
+    bool occupied;
+} WEC_KeyedEntry_T;
+
+/**
+ * Keyed windowed event counter table.
+ * Treat the members as private and operate on them through the
+ * WEC_KeyedTable* APIs.
+ */
+typedef struct {
+    /// Hash table of keys
+    WEC_KeyedEntry_T *entries;
+    /// Event rings of every entry, keyCapacity event times each
+    WEC_TIME_T *eventPool;
+    /// Number of elements in entries, a power of two
+    size_t entryCount;
+    /// Number of keys in the table
+    size_t keyCount;
+    /// Largest number of keys before the table is full
+    size_t keyLimit;
+    /// Next entry to check for an expired key when the table is full
+    size_t sweep;
+    /// Limit to the length of the time window of every key
+    WEC_TIME_T windowLimit;
+    /// Number of events each key can hold
+    WEC_COUNT_T keyCapacity;
+} WEC_KeyedTable_T;
+
+//
+// Section: Keyed Table APIs
+//
+
+/**
+ * Initializes a keyed table.
+ * Three quarters of the entries may hold keys; the rest keep probe sequences
+ * short.
+ * @param table instance to initialize
+ * @param entries storage for the hash table, must outlive the table
+ * @param entryCount number of elements in entries, a power of two
+ * @param eventBuffer storage for entryCount * keyCapacity event times, shared
+ * by every key, must outlive the table
+ * @param keyCapacity number of events each key can hold, at most the largest
+ * WEC_COUNT_T
+ * @param windowLimit maximum length of the measurement window of every key
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage or capacities cannot be used.
+ */
+WEC_ERROR_T WEC_KeyedTableInit(WEC_KeyedTable_T *table,
+        WEC_KeyedEntry_T entries[], size_t entryCount,
+        WEC_TIME_T eventBuffer[], size_t keyCapacity, WEC_TIME_T windowLimit);
+
+/**
+ * Adds an event to the window of a key.
+ * Keys not yet in the table are added.  When the table is full, expired keys
+ * on the probe chain of the new key are evicted first, then expired keys
+ * among the next WEC_KEYED_SWEEP_LENGTH entries of a sweep that carries on
+ * from the last call.
+ * @param table instance to update
+ * @param key key the event belongs to
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ * @returns WEC_TABLE_FULL when the key is new and no expired key was found
+ * to make room for it.
+ */
+WEC_ERROR_T WEC_KeyedTableEventAdd(WEC_KeyedTable_T *table, WEC_KEY_T key,
+        WEC_TIME_T eventTime);
+
+/**
+ * Gets the current number of events of a key.
+ * Removes expired events, and evicts the key when none remain.
+ * @param table instance to query
+ * @param key key to count
+ * @param currentTime
+ * @returns Count of events, 0 for keys not in the table
+ */
+WEC_COUNT_T WEC_KeyedTableEventCountGet(WEC_KeyedTable_T *table,
+        WEC_KEY_T key, WEC_TIME_T currentTime);
+
+/**
+ * Evicts every key whose window has fully expired.
+ * @param table instance to update
+ * @param currentTime
+ * @returns number of keys evicted
+ */
+size_t WEC_KeyedTableExpire(WEC_KeyedTable_T *table, WEC_TIME_T currentTime);
+
+/**
+ * Gets the number of keys in the table.
+ * @param table instance to query
+ * @returns number of keys
+ */
+size_t WEC_KeyedTableKeyCountGet(const WEC_KeyedTable_T *table);
+
+#endif // WEC_KEYED_TABLE_H
+
+//
+// End of File
+//
+
@@ -0,0 +1,384 @@
+/**
+ * @file
+ * wec_multi_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Counts events over several window lengths from a single event stream.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_multi_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Largest count a multi-resolution counter can hold
+#define WEC_MULTI_COUNT_MAX (UINT32_MAX)
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Moves the newest bucket of a level forward to the bucket covering
+/// currentTime.  Closed buckets wait to roll up into the next coarser level
+/// until a query or until their slot is needed again.
+STATIC void WEC_MultiLevelAdvance(WEC_MultiCounter_T *counter, size_t level,
+        WEC_TIME_T currentTime);
+
+/// Rolls every closed bucket of a level up into the next coarser level,
+/// oldest first
+STATIC void WEC_MultiLevelRollUp(WEC_MultiCounter_T *counter, size_t level);
+
+/// Drops the oldest bucket of a level once every event it can hold has left
+/// the window
+STATIC void WEC_MultiLevelExpire(WEC_MultiCounter_T *counter, size_t level,
+        WEC_TIME_T currentTime);
+
+/// Sums the buckets of a level with the newest buckets of every finer level,
+/// which have not rolled up yet
+STATIC WEC_BUCKET_COUNT_T WEC_MultiLevelCount(const WEC_MultiCounter_T *counter,
+        size_t level);
+
+/// Updates the start time based on the longest window limit and current time
+STATIC WEC_TIME_T WEC_MultiStartTimeUpdate(const WEC_MultiCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Shifts the buckets of every level and the window start forward to
+/// currentTime, rolling up every closed bucket
+STATIC WEC_ERROR_T WEC_MultiWindowShift(WEC_MultiCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+// Recursion depth is bounded by WEC_MULTI_LEVELS_MAX
+STATIC void WEC_MultiLevelAdvance(WEC_MultiCounter_T *counter, size_t level,
+        WEC_TIME_T currentTime) {
+    WEC_MultiLevel_T *current = &counter->levels[level];
+    WEC_TIME_T elapsed = currentTime - current->bucketStart;
+    if (elapsed < current->bucketWidth) {
+        return;
+    }
+
+    bool coarser = ((level + 1U) < counter->levelCount);
+    WEC_TIME_T steps = elapsed / current->bucketWidth;
+    WEC_TIME_T clears = (steps < current->slots) ? steps : current->slots;
+    while (clears--) {
+        // The oldest bucket is about to be reused, it must roll up first
+        if (coarser && ((current->slots - 1U) <= current->unrolled)) {
+            WEC_MultiLevelRollUp(counter, level);
+        }
+        current->bucketStart += current->bucketWidth;
+        steps--;
+        if (coarser) {
+            current->unrolled++;
+        }
+
+        current->newest++;
+        if (current->slots <= current->newest) {
+            current->newest = 0U;
+        }
+        WEC_BUCKET_COUNT_T dropped = current->buckets[current->newest];
+        current->total -= dropped;
+        if (!coarser) {
+            counter->count -= dropped;
+        }
+        current->buckets[current->newest] = 0U;
+    }
+    // Every bucket is empty now, the remaining steps have nothing to roll up
+    if (0U < steps) {
+        current->bucketStart += steps * current->bucketWidth;
+        current->unrolled = 0U;
+    }
+}
+
+STATIC void WEC_MultiLevelRollUp(WEC_MultiCounter_T *counter, size_t level) {
+    WEC_MultiLevel_T *current = &counter->levels[level];
+    WEC_MultiLevel_T *next = &counter->levels[level + 1U];
+    while (0U < current->unrolled) {
+        uint16_t index;
+        if (current->unrolled <= current->newest) {
+            index = current->newest - current->unrolled;
+        } else {
+            index = (current->newest + current->slots) - current->unrolled;
+        }
+
+        WEC_BUCKET_COUNT_T closed = current->buckets[index];
+        if (0U != closed) {
+            WEC_TIME_T closedStart = current->bucketStart
+                    - ((WEC_TIME_T) current->unrolled * current->bucketWidth);
+            WEC_MultiLevelAdvance(counter, level + 1U, closedStart);
+            next->buckets[next->newest] += closed;
+            next->total += closed;
+        }
+        current->unrolled--;
+    }
+}
+
+STATIC void WEC_MultiLevelExpire(WEC_MultiCounter_T *counter, size_t level,
+        WEC_TIME_T currentTime) {
+    WEC_MultiLevel_T *current = &counter->levels[level];
+    uint16_t oldest = current->newest + 1U;
+    if (current->slots <= oldest) {
+        oldest = 0U;
+    }
+
+    // Age of the newest time the oldest bucket could have recorded
+    WEC_TIME_T age = (WEC_TIME_T) ((currentTime - current->bucketStart)
+            + ((WEC_TIME_T) (current->slots - 2U) * current->bucketWidth)
+            + 1U);
+    if (age >= current->windowLimit) {
+        WEC_BUCKET_COUNT_T dropped = current->buckets[oldest];
+        current->total -= dropped;
+        if ((level + 1U) == counter->levelCount) {
+            counter->count -= dropped;
+        }
+        current->buckets[oldest] = 0U;
+    }
+}
+
+STATIC WEC_BUCKET_COUNT_T WEC_MultiLevelCount(const WEC_MultiCounter_T *counter,
+        size_t level) {
+    WEC_BUCKET_COUNT_T count = counter->levels[level].total;
+    for (size_t i = 0U; i < level; i++) {
+        const WEC_MultiLevel_T *finer = &counter->levels[i];
+        count += finer->buckets[finer->newest];
+    }
+    return count;
+}
+
+STATIC WEC_TIME_T WEC_MultiStartTimeUpdate(const WEC_MultiCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T windowLimit = counter->levels[counter->levelCount - 1U].windowLimit;
+    WEC_TIME_T newStart;
+    if ((WEC_TIME_T) (currentTime - counter->startTime) >= windowLimit) {
+        newStart = currentTime - windowLimit;
+    } else {
+        newStart = counter->startTime;
+    }
+    return newStart;
+}
+
+STATIC WEC_ERROR_T WEC_MultiWindowShift(WEC_MultiCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_MultiStartTimeUpdate(counter, currentTime);
+        for (size_t i = 0U; i < counter->levelCount; i++) {
+            WEC_MultiLevelAdvance(counter, i, currentTime);
+            if ((i + 1U) < counter->levelCount) {
+                WEC_MultiLevelRollUp(counter, i);
+            }
+            WEC_MultiLevelExpire(counter, i, currentTime);
+        }
+        return WEC_OKAY;
+    }
+    return WEC_NOT_STARTED;
+}
+
+//
+// Section: Multi-Resolution Counter APIs
+//
+
+WEC_ERROR_T WEC_MultiCounterInit(WEC_MultiCounter_T *counter,
+        const WEC_TIME_T windowLimits[], size_t windowCount) {
+    assert(NULL != counter);
+    assert(NULL != windowLimits);
+    if ((0U == windowCount) || (WEC_MULTI_LEVELS_MAX < windowCount)) {
+        return WEC_ERROR;
+    }
+
+    WEC_TIME_T finerWidth = 1U;
+    for (size_t i = 0U; i < windowCount; i++) {
+        WEC_TIME_T windowLimit = windowLimits[i];
+        if ((0U == windowLimit)
+                || ((0U < i) && (windowLimit <= windowLimits[i - 1U]))) {
+            return WEC_ERROR;
+        }
+
+        // Widest multiple of the finer width that still gives the window
+        // WEC_BUCKET_RESOLUTION buckets, so every finer bucket lies inside a
+        // single bucket of this level
+        WEC_TIME_T width = windowLimit / WEC_BUCKET_RESOLUTION;
+        if ((width * WEC_BUCKET_RESOLUTION) < windowLimit) {
+            width++;
+        }
+        if (0U < i) {
+            width = (width / finerWidth) * finerWidth;
+        }
+        if (width < finerWidth) {
+            width = finerWidth;
+        }
+
+        WEC_TIME_T buckets = windowLimit / width;
+        if ((buckets * width) < windowLimit) {
+            buckets++;
+        }
+        if (WEC_MULTI_BUCKETS_MAX < (buckets + 1U)) {
+            return WEC_ERROR;
+        }
+
+        WEC_MultiLevel_T *level = &counter->levels[i];
+        level->bucketStart = 0U;
+        level->bucketWidth = width;
+        level->windowLimit = windowLimit;
+        level->slots = (uint16_t) (buckets + 1U);
+        finerWidth = width;
+    }
+
+    counter->levelCount = windowCount;
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->started = false;
+    WEC_MultiCounterEventsClear(counter);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_MultiCounterEventAdd(WEC_MultiCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (false == counter->started) {
+        return WEC_NOT_STARTED;
+    }
+    if (WEC_MULTI_COUNT_MAX <= counter->count) {
+        // The running count may still hold events that have left the window
+        (void) WEC_MultiWindowShift(counter, eventTime);
+        if (WEC_MULTI_COUNT_MAX <= counter->count) {
+            return WEC_BUFFER_OVERFLOW;
+        }
+    }
+    WEC_MultiLevelAdvance(counter, 0U, eventTime);
+    WEC_MultiLevel_T *finest = &counter->levels[0];
+    finest->buckets[finest->newest]++;
+    finest->total++;
+    counter->count++;
+    return WEC_OKAY;
+}
+
+WEC_BUCKET_COUNT_T WEC_MultiCounterEventCountGet(WEC_MultiCounter_T *counter,
+        size_t window, WEC_TIME_T currentTime) {
+    assert(window < counter->levelCount);
+    (void) WEC_MultiWindowShift(counter, currentTime);
+    return WEC_MultiLevelCount(counter, window);
+}
+
+void WEC_MultiCounterEventsClear(WEC_MultiCounter_T *counter) {
+    for (size_t i = 0U; i < counter->levelCount; i++) {
+        WEC_MultiLevel_T *level = &counter->levels[i];
+        for (uint16_t j = 0U; j < WEC_MULTI_BUCKETS_MAX; j++) {
+            level->buckets[j] = 0U;
+        }
+        level->total = 0U;
+        level->newest = 0U;
+        level->unrolled = 0U;
+    }
+    counter->count = 0U;
+}
+
+WEC_TIME_T WEC_MultiCounterWindowLimitGet(const WEC_MultiCounter_T *counter,
+        size_t window) {
+    assert(window < counter->levelCount);
+    return counter->levels[window].windowLimit;
+}
+
+WEC_ERROR_T WEC_MultiCounterWindowStart(WEC_MultiCounter_T *counter,
+        WEC_TIME_T startTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == counter->started) {
+        err = WEC_OKAY;
+        counter->started = true;
+        counter->startTime = startTime;
+        bool empty = true;
+        for (size_t i = 0U; i < counter->levelCount; i++) {
+            empty = empty && (0U == counter->levels[i].total);
+        }
+        // Common origin keeps the bucket edges of every level aligned
+        if (empty) {
+            for (size_t i = 0U; i < counter->levelCount; i++) {
+                counter->levels[i].bucketStart = startTime;
+            }
+        }
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_MultiCounterWindowStop(WEC_MultiCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (true == counter->started) {
+        err = WEC_OKAY;
+        (void) WEC_MultiWindowShift(counter, stopTime);
+        counter->started = false;
+        counter->stopTime = stopTime;
+    } else {
+        err = WEC_NOT_STARTED;
+    }
+    return err;
+}
+
+WEC_TIME_T WEC_MultiCounterWindowTimeGet(WEC_MultiCounter_T *counter,
+        size_t window, WEC_TIME_T currentTime) {
+    assert(window < counter->levelCount);
+    WEC_TIME_T windowTime;
+    if (counter->started) {
+        counter->startTime = WEC_MultiStartTimeUpdate(counter, currentTime);
+        windowTime = currentTime - counter->startTime;
+    } else {
+        windowTime = counter->stopTime - counter->startTime;
+    }
+    if (counter->levels[window].windowLimit < windowTime) {
+        windowTime = counter->levels[window].windowLimit;
+    }
+    return windowTime;
+}
+
+//
+// End of File
+//
+
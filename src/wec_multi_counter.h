@@ -0,0 +1,211 @@
+/**
+ * @file
+ * wec_multi_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Counts events over several window lengths from a single event stream.
+ *
+ * Each window length is a level of time buckets, finest first.  Events are
+ * only ever added to the newest bucket of the finest level.  Closed buckets
+ * roll up into the next coarser level when a window is queried, or when the
+ * finest level runs out of buckets, so adding an event costs the same no
+ * matter how many windows are tracked.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_MULTI_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_MULTI_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "wec_bucket_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Largest number of window lengths one counter can track
+#    ifndef WEC_MULTI_LEVELS_MAX
+#        define WEC_MULTI_LEVELS_MAX (4U)
+#    endif
+
+/// Number of buckets stored per level.  Bucket widths must nest, so a level
+/// may need up to twice WEC_BUCKET_RESOLUTION buckets to cover its window, plus
+/// the partially expired oldest bucket.
+#    define WEC_MULTI_BUCKETS_MAX ((2U * WEC_BUCKET_RESOLUTION) + 1U)
+
+//
+// Section: Data Types
+//
+
+/**
+ * Buckets covering one window length.
+ * Treat the members as private.
+ */
+typedef struct {
+    /// Count of events in each bucket
+    WEC_BUCKET_COUNT_T buckets[WEC_MULTI_BUCKETS_MAX];
+    /// Sum of all buckets
+    WEC_BUCKET_COUNT_T total;
+    /// Timestamp marking the start of the newest bucket
+    WEC_TIME_T bucketStart;
+    /// Length of time covered by each bucket, a multiple of the finer level's
+    WEC_TIME_T bucketWidth;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// Number of buckets in use, including the partially expired one
+    uint16_t slots;
+    /// index of the newest bucket
+    uint16_t newest;
+    /// Number of closed buckets not yet rolled up into the coarser level
+    uint16_t unrolled;
+} WEC_MultiLevel_T;
+
+/**
+ * Multi-resolution windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_MultiCounter* APIs.
+ */
+typedef struct {
+    /// One level per window length, finest first
+    WEC_MultiLevel_T levels[WEC_MULTI_LEVELS_MAX];
+    /// Number of levels in use
+    size_t levelCount;
+    /// Events held by any level that have not left the longest window yet
+    WEC_BUCKET_COUNT_T count;
+    /// Timestamp marking the start of the longest measurement window
+    WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+    /// Indicates when window is started and running
+    bool started;
+} WEC_MultiCounter_T;
+
+//
+// Section: Multi-Resolution Counter APIs
+//
+
+/**
+ * Initializes a multi-resolution counter.
+ * The counter starts out stopped and empty.
+ * @param counter instance to initialize
+ * @param windowLimits length of each window, shortest first
+ * @param windowCount number of elements in windowLimits, at most
+ * WEC_MULTI_LEVELS_MAX
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the window limits cannot be used.
+ */
+WEC_ERROR_T WEC_MultiCounterInit(WEC_MultiCounter_T *counter,
+        const WEC_TIME_T windowLimits[], size_t windowCount);
+
+/**
+ * Adds an event to every window.
+ * Only the finest level is updated, the coarser levels catch up on the next
+ * query.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when the bucket total would overflow, the event
+ * is not counted.
+ */
+WEC_ERROR_T WEC_MultiCounterEventAdd(WEC_MultiCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+/**
+ * Gets the current number of events in one window.
+ * Events are counted to within one bucket of the window.
+ * @param counter instance to query
+ * @param window index of the window length given to WEC_MultiCounterInit()
+ * @param currentTime
+ * @returns Count of events
+ */
+WEC_BUCKET_COUNT_T WEC_MultiCounterEventCountGet(WEC_MultiCounter_T *counter,
+        size_t window, WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events.
+ * @param counter instance to clear
+ */
+void WEC_MultiCounterEventsClear(WEC_MultiCounter_T *counter);
+
+/**
+ * Gets the limit of one window.
+ * @param counter instance to query
+ * @param window index of the window length given to WEC_MultiCounterInit()
+ * @returns the window limit
+ */
+WEC_TIME_T WEC_MultiCounterWindowLimitGet(const WEC_MultiCounter_T *counter,
+        size_t window);
+
+/**
+ * Starts measurement
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_MultiCounterWindowStart(WEC_MultiCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_MultiCounterWindowStop(WEC_MultiCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of one measurement window
+ * @param counter instance to query
+ * @param window index of the window length given to WEC_MultiCounterInit()
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_MultiCounterWindowTimeGet(WEC_MultiCounter_T *counter,
+        size_t window, WEC_TIME_T currentTime);
+
+#endif // WEC_MULTI_COUNTER_H
+
+//
+// End of File
+//
+
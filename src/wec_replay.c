@@ -0,0 +1,289 @@
+/**
+ * @file
+ * wec_replay.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Offline sliding window counts over recorded event logs.
+ *
+ * Each chunk walks the log with two indices: the event being reported and the
+ * oldest event still in its window.  Both only move forward, so a chunk costs
+ * time linear in its length plus the one window it reaches back into.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_replay.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+#include <pthread.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Smallest difference between two times taken to run backwards
+#define WEC_TIME_HALF ((WEC_TIME_T) (((WEC_TIME_T) ~(WEC_TIME_T) 0 / 2U) + 1U))
+
+/// Most threads a replay splits its work across
+#define WEC_REPLAY_THREADS_MAX 64U
+
+//
+// Section: Data Types
+//
+
+/// Work handed to one thread
+typedef struct {
+    /// Every event time in the log
+    const WEC_TIME_T *eventTimes;
+    /// Number of events in the log, used by sample chunks
+    size_t eventCount;
+    /// Index of the first event or sample of the chunk
+    size_t begin;
+    /// Index one past the last event or sample of the chunk
+    size_t end;
+    /// Maximum length of measurement window
+    WEC_TIME_T windowLimit;
+    /// Time of the first sample of the whole replay
+    WEC_TIME_T sampleStart;
+    /// Time between samples
+    WEC_TIME_T sampleInterval;
+    /// Receives the counts of the whole replay
+    size_t *counts;
+    /// Offset subtracted from begin and end to index counts
+    size_t countsBase;
+    /// Set when an event is older than the one before it
+    bool outOfOrder;
+} WEC_ReplayChunk_T;
+
+/// Counts one chunk of work
+typedef void *(*WEC_ReplayWorker_T)(void *chunk);
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Counts the window after each event of a chunk
+STATIC void *WEC_ReplayEventChunk(void *chunk);
+
+/// Counts the window at each sample of a chunk
+STATIC void *WEC_ReplaySampleChunk(void *chunk);
+
+/// Finds the number of events at or before time
+STATIC size_t WEC_ReplayEventsThrough(const WEC_TIME_T eventTimes[],
+        size_t eventCount, WEC_TIME_T time);
+
+/// Splits items into chunks and counts them across threads
+STATIC void WEC_ReplayRun(WEC_ReplayChunk_T *prototype, size_t first,
+        size_t itemCount, size_t threadCount, WEC_ReplayWorker_T worker);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC void *WEC_ReplayEventChunk(void *chunk) {
+    WEC_ReplayChunk_T *work = chunk;
+    const WEC_TIME_T *times = work->eventTimes;
+    size_t oldest = work->begin;
+
+    // Reach back into the window of the first event, one event at a time so
+    // the ages stay valid across time wrap around
+    while ((0U < oldest)
+            && ((WEC_TIME_T) (times[work->begin] - times[oldest - 1U])
+                    < work->windowLimit)) {
+        oldest--;
+    }
+
+    for (size_t index = work->begin; index < work->end; index++) {
+        if ((0U < index)
+                && (WEC_TIME_HALF
+                        <= (WEC_TIME_T) (times[index] - times[index - 1U]))) {
+            work->outOfOrder = true;
+        }
+        while ((oldest <= index)
+                && ((WEC_TIME_T) (times[index] - times[oldest])
+                        >= work->windowLimit)) {
+            oldest++;
+        }
+        work->counts[index - work->countsBase] = index + 1U - oldest;
+    }
+
+    return NULL;
+}
+
+STATIC void *WEC_ReplaySampleChunk(void *chunk) {
+    WEC_ReplayChunk_T *work = chunk;
+
+    for (size_t index = work->begin; index < work->end; index++) {
+        WEC_TIME_T sampleTime = (WEC_TIME_T) (work->sampleStart
+                + ((WEC_TIME_T) index * work->sampleInterval));
+        size_t newest = WEC_ReplayEventsThrough(work->eventTimes,
+                work->eventCount, sampleTime);
+        size_t expired = 0U;
+
+        // Events exactly one window limit old have expired
+        if (sampleTime >= work->windowLimit) {
+            expired = WEC_ReplayEventsThrough(work->eventTimes,
+                    work->eventCount,
+                    (WEC_TIME_T) (sampleTime - work->windowLimit));
+        }
+        work->counts[index] = newest - expired;
+    }
+
+    return NULL;
+}
+
+STATIC size_t WEC_ReplayEventsThrough(const WEC_TIME_T eventTimes[],
+        size_t eventCount, WEC_TIME_T time) {
+    size_t low = 0U;
+    size_t high = eventCount;
+
+    while (low < high) {
+        size_t middle = low + ((high - low) / 2U);
+        if (eventTimes[middle] <= time) {
+            low = middle + 1U;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+STATIC void WEC_ReplayRun(WEC_ReplayChunk_T *prototype, size_t first,
+        size_t itemCount, size_t threadCount, WEC_ReplayWorker_T worker) {
+    WEC_ReplayChunk_T chunks[WEC_REPLAY_THREADS_MAX];
+    pthread_t threads[WEC_REPLAY_THREADS_MAX];
+    bool started[WEC_REPLAY_THREADS_MAX];
+
+    if (threadCount > WEC_REPLAY_THREADS_MAX) {
+        threadCount = WEC_REPLAY_THREADS_MAX;
+    }
+    if (threadCount > itemCount) {
+        threadCount = itemCount;
+    }
+    if (0U == threadCount) {
+        threadCount = 1U;
+    }
+
+    for (size_t thread = 0U; thread < threadCount; thread++) {
+        chunks[thread] = *prototype;
+        chunks[thread].begin = first + ((itemCount * thread) / threadCount);
+        chunks[thread].end = first
+                + ((itemCount * (thread + 1U)) / threadCount);
+        // The first chunk runs on the calling thread once the rest are going
+        started[thread] = (0U < thread)
+                && (0 == pthread_create(&threads[thread], NULL, worker,
+                        &chunks[thread]));
+    }
+
+    // Chunks whose thread could not be created are counted here instead
+    for (size_t thread = 0U; thread < threadCount; thread++) {
+        if (false == started[thread]) {
+            (void) worker(&chunks[thread]);
+        }
+    }
+    for (size_t thread = 0U; thread < threadCount; thread++) {
+        if (true == started[thread]) {
+            (void) pthread_join(threads[thread], NULL);
+        }
+        prototype->outOfOrder |= chunks[thread].outOfOrder;
+    }
+}
+
+//
+// Section: API Functions
+//
+
+WEC_ERROR_T WEC_ReplayEventCounts(const WEC_TIME_T eventTimes[], size_t first,
+        size_t eventCount, WEC_TIME_T windowLimit, size_t counts[],
+        size_t threadCount) {
+    assert((NULL != eventTimes) || (0U == eventCount));
+    assert((NULL != counts) || (0U == eventCount));
+
+    WEC_ReplayChunk_T prototype = {
+        .eventTimes = eventTimes,
+        .windowLimit = windowLimit,
+        .counts = counts,
+        .countsBase = first,
+        .outOfOrder = false,
+    };
+
+    WEC_ReplayRun(&prototype, first, eventCount, threadCount,
+            WEC_ReplayEventChunk);
+
+    return (true == prototype.outOfOrder) ? WEC_ERROR : WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_ReplaySampleCounts(const WEC_TIME_T eventTimes[],
+        size_t eventCount, WEC_TIME_T windowLimit, WEC_TIME_T sampleStart,
+        WEC_TIME_T sampleInterval, size_t sampleCount, size_t counts[],
+        size_t threadCount) {
+    assert((NULL != eventTimes) || (0U == eventCount));
+    assert((NULL != counts) || (0U == sampleCount));
+
+    if ((0U == sampleInterval) && (1U < sampleCount)) {
+        return WEC_ERROR;
+    }
+
+    WEC_ReplayChunk_T prototype = {
+        .eventTimes = eventTimes,
+        .eventCount = eventCount,
+        .windowLimit = windowLimit,
+        .sampleStart = sampleStart,
+        .sampleInterval = sampleInterval,
+        .counts = counts,
+        .countsBase = 0U,
+        .outOfOrder = false,
+    };
+
+    WEC_ReplayRun(&prototype, 0U, sampleCount, threadCount,
+            WEC_ReplaySampleChunk);
+
+    return WEC_OKAY;
+}
+
+//
+// End of File
+//
+
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * wec_replay.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Offline sliding window counts over recorded event logs.
+ *
+ * Replays a whole log of event times at once instead of feeding it through a
+ * counter one event at a time.  Counts are not capped by any buffer, and the
+ * log is split into chunks counted in parallel, each chunk starting its
+ * window from the events one window length before it.  For a log of non
+ * decreasing times, every count equals what a counter large enough to hold
+ * the window reports, including events exactly one window limit old having
+ * expired.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_REPLAY_H    // Guards against multiple inclusion
+#    define WEC_REPLAY_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: APIs
+//
+
+/**
+ * Computes the count of events in the window right after each event is added.
+ * Matches calling WEC_CounterEventCountGet() at each event's time right after
+ * WEC_CounterEventAdd().  Events before first count toward the windows of the
+ * reported events, so a long log can be reported a block at a time.  Time
+ * stamps may wrap around.
+ * @param eventTimes every event time in the log, oldest first
+ * @param first index of the first event to report
+ * @param eventCount number of events to report
+ * @param windowLimit maximum length of measurement window
+ * @param counts receives eventCount counts
+ * @param threadCount number of threads sharing the work, 0 or 1 to work on
+ * the calling thread alone
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when a reported event is older than the one before it;
+ * the counts are then not meaningful.
+ */
+WEC_ERROR_T WEC_ReplayEventCounts(const WEC_TIME_T eventTimes[], size_t first,
+        size_t eventCount, WEC_TIME_T windowLimit, size_t counts[],
+        size_t threadCount);
+
+/**
+ * Computes the count of events in the window at evenly spaced sample times.
+ * Matches calling WEC_CounterEventCountGet() at each sample time after adding
+ * every event up to and including that time.  Time stamps and sample times are
+ * compared directly, so the log must not wrap around.
+ * @param eventTimes every event time in the log, oldest first
+ * @param eventCount number of events in the log
+ * @param windowLimit maximum length of measurement window
+ * @param sampleStart time of the first sample
+ * @param sampleInterval time between samples
+ * @param sampleCount number of samples
+ * @param counts receives sampleCount counts
+ * @param threadCount number of threads sharing the work, 0 or 1 to work on
+ * the calling thread alone
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when sampleInterval is 0 with more than one sample.
+ */
+WEC_ERROR_T WEC_ReplaySampleCounts(const WEC_TIME_T eventTimes[],
+        size_t eventCount, WEC_TIME_T windowLimit, WEC_TIME_T sampleStart,
+        WEC_TIME_T sampleInterval, size_t sampleCount, size_t counts[],
+        size_t threadCount);
+
+#endif // WEC_REPLAY_H
+
+//
+// End of File
+//
+
@@ -0,0 +1,151 @@
+/**
+ * @file
+ * wec_sharded_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Windowed event counter sharded across producer threads.
+ *
+ * Window control is applied to every shard in turn.  Since all shards share
+ * the same window settings, shard 0 answers the settings queries.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_sharded_counter.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Producer APIs
+//
+
+WEC_ERROR_T WEC_ShardedCounterEventAdd(WEC_ShardedCounter_T *counter,
+        size_t shard, WEC_TIME_T eventTime) {
+    assert(shard < counter->shardCount);
+    return WEC_SpscCounterEventAdd(&counter->shards[shard], eventTime);
+}
+
+//
+// Section: Consumer APIs
+//
+
+WEC_ERROR_T WEC_ShardedCounterInit(WEC_ShardedCounter_T *counter,
+        WEC_SpscCounter_T shards[], size_t shardCount,
+        WEC_TIME_T eventBuffer[], size_t shardCapacity) {
+    assert(NULL != counter);
+    if ((NULL == shards) || (0U == shardCount) || (NULL == eventBuffer)) {
+        return WEC_ERROR;
+    }
+    for (size_t i = 0U; i < shardCount; i++) {
+        WEC_TIME_T *shardBuffer = &eventBuffer[i
+                * WEC_SHARD_STRIDE(shardCapacity)];
+        if (WEC_OKAY != WEC_SpscCounterInit(&shards[i], shardBuffer,
+                shardCapacity)) {
+            return WEC_ERROR;
+        }
+    }
+    counter->shards = shards;
+    counter->shardCount = shardCount;
+    return WEC_OKAY;
+}
+
+size_t WEC_ShardedCounterEventCountGet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    size_t count = 0U;
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        count += WEC_SpscCounterEventCountGet(&counter->shards[i], currentTime);
+    }
+    return count;
+}
+
+void WEC_ShardedCounterEventsClear(WEC_ShardedCounter_T *counter) {
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        WEC_SpscCounterEventsClear(&counter->shards[i]);
+    }
+}
+
+WEC_TIME_T WEC_ShardedCounterWindowLimitGet(const WEC_ShardedCounter_T *counter) {
+    return WEC_SpscCounterWindowLimitGet(&counter->shards[0]);
+}
+
+WEC_ERROR_T WEC_ShardedCounterWindowLimitSet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    WEC_ERROR_T err = WEC_OKAY;
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        err = WEC_SpscCounterWindowLimitSet(&counter->shards[i], windowLimit);
+        if (WEC_OKAY != err) {
+            break;
+        }
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_ShardedCounterWindowStart(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T startTime) {
+    WEC_ERROR_T err = WEC_OKAY;
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        err = WEC_SpscCounterWindowStart(&counter->shards[i], startTime);
+        if (WEC_OKAY != err) {
+            break;
+        }
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_ShardedCounterWindowStop(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_OKAY;
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        err = WEC_SpscCounterWindowStop(&counter->shards[i], stopTime);
+        if (WEC_OKAY != err) {
+            break;
+        }
+    }
+    return err;
+}
+
+WEC_TIME_T WEC_ShardedCounterWindowTimeGet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T windowTime = 0U;
+    for (size_t i = 0U; i < counter->shardCount; i++) {
+        windowTime = WEC_SpscCounterWindowTimeGet(&counter->shards[i],
+                currentTime);
+    }
+    return windowTime;
+}
+
+//
+// End of File
+//
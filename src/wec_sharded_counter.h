@@ -0,0 +1,190 @@
+/**
+ * @file
+ * wec_sharded_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Windowed event counter sharded across producer threads.
+ *
+ * Each producer thread records events into its own shard, so producers never
+ * contend for the same cache lines.  Shards are single producer single consumer
+ * counters, and a single query thread sums their counts, expiring each shard
+ * against the query time first.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_SHARDED_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_SHARDED_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "wec_spsc_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Macros
+//
+
+/// Number of event buffer elements reserved for each shard.  Rounds the shard
+/// capacity up to whole cache lines so no two shards share a line.
+#    define WEC_SHARD_STRIDE(shardCapacity) \
+        ((((shardCapacity) * sizeof (WEC_TIME_T) + WEC_CACHE_LINE_SIZE - 1U) \
+        / WEC_CACHE_LINE_SIZE) * WEC_CACHE_LINE_SIZE / sizeof (WEC_TIME_T))
+
+//
+// Section: Data Types
+//
+
+/**
+ * Sharded windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_ShardedCounter* APIs.
+ */
+typedef struct {
+    /// One counter per producer thread
+    WEC_SpscCounter_T *shards;
+    /// Number of elements in shards
+    size_t shardCount;
+} WEC_ShardedCounter_T;
+
+//
+// Section: Producer APIs
+//
+
+/**
+ * Adds an event to a shard.
+ * Each shard may only be used by one producer thread at a time.
+ * @param counter instance to update
+ * @param shard index of the calling thread's shard
+ * @param eventTime time at which the event was detected
+ * @returns error code
+ * @see WEC_SpscCounterEventAdd
+ */
+WEC_ERROR_T WEC_ShardedCounterEventAdd(WEC_ShardedCounter_T *counter,
+        size_t shard, WEC_TIME_T eventTime);
+
+//
+// Section: Consumer APIs
+//
+
+/**
+ * Initializes a sharded counter.
+ * Must complete before any producer or consumer uses the counter.
+ * @param counter instance to initialize
+ * @param shards storage for shardCount shards, must outlive the counter
+ * @param shardCount number of shards, usually one per producer thread
+ * @param eventBuffer storage for shardCount * WEC_SHARD_STRIDE(shardCapacity)
+ * event times, aligned to WEC_CACHE_LINE_SIZE
+ * @param shardCapacity number of events each shard holds, a power of two
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage or capacity cannot be used.
+ */
+WEC_ERROR_T WEC_ShardedCounterInit(WEC_ShardedCounter_T *counter,
+        WEC_SpscCounter_T shards[], size_t shardCount,
+        WEC_TIME_T eventBuffer[], size_t shardCapacity);
+
+/**
+ * Gets the current number of events across all shards.
+ * May only be called from one consumer thread.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Count of events
+ */
+size_t WEC_ShardedCounterEventCountGet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events added so far.
+ * May only be called from the consumer thread.
+ * @param counter instance to clear
+ */
+void WEC_ShardedCounterEventsClear(WEC_ShardedCounter_T *counter);
+
+/**
+ * Gets the value of the current window limit.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_ShardedCounterWindowLimitGet(const WEC_ShardedCounter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window of every shard.
+ * May only be called from the consumer thread.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @return error
+ */
+WEC_ERROR_T WEC_ShardedCounterWindowLimitSet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Starts measurement on every shard.
+ * May only be called from the consumer thread.
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_ShardedCounterWindowStart(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement on every shard.
+ * May only be called from the consumer thread.
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_ShardedCounterWindowStop(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window
+ * May only be called from the consumer thread.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_ShardedCounterWindowTimeGet(WEC_ShardedCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+#endif // WEC_SHARDED_COUNTER_H
+
+//
+// End of File
+//
+
@@ -0,0 +1,264 @@
+/**
+ * @file
+ * wec_spsc_counter.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Lock-free windowed event counter for one producer and one consumer.
+ *
+ * The producer publishes each event with a release store of the head index and
+ * the consumer publishes expiry with a release store of the tail index.  Each
+ * side only reads the other side's index with an acquire load.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_spsc_counter.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+/// Maps a free running index onto its slot in the event buffer
+#define WEC_SPSC_SLOT(counter, index) ((index) & ((counter)->capacity - 1U))
+
+//
+// Section: Constants
+//
+
+/// Ages beyond this are events stamped after the current time
+#define WEC_SPSC_AGE_MAX ((WEC_TIME_T) ((WEC_TIME_T) ~(WEC_TIME_T) 0 >> 1))
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Checks whether an event has left the window at currentTime
+STATIC bool WEC_SpscEventExpired(const WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventTime, WEC_TIME_T currentTime);
+
+/// Removes events equal to or older than the window limit
+STATIC void WEC_SpscEventExpire(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/// Updates the start time based on the window limit and current time
+STATIC WEC_TIME_T WEC_SpscStartTimeUpdate(const WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC bool WEC_SpscEventExpired(const WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventTime, WEC_TIME_T currentTime) {
+    WEC_TIME_T age = currentTime - eventTime;
+    return (age >= counter->windowLimit) && (age <= WEC_SPSC_AGE_MAX);
+}
+
+STATIC void WEC_SpscEventExpire(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_COUNT_T tail = atomic_load_explicit(&counter->tail,
+            memory_order_relaxed);
+    WEC_COUNT_T head = atomic_load_explicit(&counter->head,
+            memory_order_acquire);
+    WEC_COUNT_T count = head - tail;
+
+    // Ages only decrease from tail to head, apart from events stamped after
+    // currentTime which are never expired, so the expired events are a run
+    // starting at the tail.  Binary search for the first event still in the
+    // window.
+    WEC_COUNT_T low = 0U;
+    WEC_COUNT_T high = count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T slot = WEC_SPSC_SLOT(counter, (WEC_COUNT_T) (tail + mid));
+        if (WEC_SpscEventExpired(counter, counter->eventBuffer[slot],
+                currentTime)) {
+            low = mid + 1U;
+        } else {
+            high = mid;
+        }
+    }
+    if (0U != low) {
+        atomic_store_explicit(&counter->tail, (WEC_COUNT_T) (tail + low),
+                memory_order_release);
+    }
+}
+
+STATIC WEC_TIME_T WEC_SpscStartTimeUpdate(const WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T newStart;
+    if ((WEC_TIME_T) (currentTime - counter->startTime)
+            >= counter->windowLimit) {
+        newStart = currentTime - counter->windowLimit;
+    } else {
+        newStart = counter->startTime;
+    }
+    return newStart;
+}
+
+//
+// Section: Producer APIs
+//
+
+WEC_ERROR_T WEC_SpscCounterEventAdd(WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (false == atomic_load_explicit(&counter->started,
+            memory_order_acquire)) {
+        return WEC_NOT_STARTED;
+    }
+    WEC_COUNT_T head = atomic_load_explicit(&counter->head,
+            memory_order_relaxed);
+    WEC_COUNT_T tail = atomic_load_explicit(&counter->tail,
+            memory_order_acquire);
+    if ((WEC_COUNT_T) (head - tail) >= counter->capacity) {
+        return WEC_BUFFER_OVERFLOW;
+    }
+    counter->eventBuffer[WEC_SPSC_SLOT(counter, head)] = eventTime;
+    atomic_store_explicit(&counter->head, (WEC_COUNT_T) (head + 1U),
+            memory_order_release);
+    return WEC_OKAY;
+}
+
+//
+// Section: Consumer APIs
+//
+
+WEC_ERROR_T WEC_SpscCounterInit(WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventBuffer[], size_t capacity) {
+    assert(NULL != counter);
+    if ((NULL == eventBuffer) || (0U == capacity)
+            || (0U != (capacity & (capacity - 1U)))
+            || ((WEC_COUNT_T) ~(WEC_COUNT_T) 0 < capacity)) {
+        return WEC_ERROR;
+    }
+    counter->eventBuffer = eventBuffer;
+    counter->capacity = (WEC_COUNT_T) capacity;
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->windowLimit = 0U;
+    atomic_init(&counter->head, 0U);
+    atomic_init(&counter->tail, 0U);
+    atomic_init(&counter->started, false);
+    return WEC_OKAY;
+}
+
+WEC_COUNT_T WEC_SpscCounterEventCountGet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    if (atomic_load_explicit(&counter->started, memory_order_relaxed)) {
+        counter->startTime = WEC_SpscStartTimeUpdate(counter, currentTime);
+        WEC_SpscEventExpire(counter, currentTime);
+    }
+    WEC_COUNT_T tail = atomic_load_explicit(&counter->tail,
+            memory_order_relaxed);
+    WEC_COUNT_T head = atomic_load_explicit(&counter->head,
+            memory_order_acquire);
+    return head - tail;
+}
+
+void WEC_SpscCounterEventsClear(WEC_SpscCounter_T *counter) {
+    WEC_COUNT_T head = atomic_load_explicit(&counter->head,
+            memory_order_acquire);
+    atomic_store_explicit(&counter->tail, head, memory_order_release);
+}
+
+WEC_TIME_T WEC_SpscCounterWindowLimitGet(const WEC_SpscCounter_T *counter) {
+    return counter->windowLimit;
+}
+
+WEC_ERROR_T WEC_SpscCounterWindowLimitSet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T windowLimit) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == atomic_load_explicit(&counter->started,
+            memory_order_relaxed)) {
+        err = WEC_OKAY;
+        counter->windowLimit = windowLimit;
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_SpscCounterWindowStart(WEC_SpscCounter_T *counter,
+        WEC_TIME_T startTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (false == atomic_load_explicit(&counter->started,
+            memory_order_relaxed)) {
+        err = WEC_OKAY;
+        counter->startTime = startTime;
+        atomic_store_explicit(&counter->started, true, memory_order_release);
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_SpscCounterWindowStop(WEC_SpscCounter_T *counter,
+        WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (true == atomic_load_explicit(&counter->started,
+            memory_order_relaxed)) {
+        err = WEC_OKAY;
+        (void) WEC_SpscCounterEventCountGet(counter, stopTime);
+        atomic_store_explicit(&counter->started, false, memory_order_release);
+        counter->stopTime = stopTime;
+    } else {
+        err = WEC_NOT_STARTED;
+    }
+    return err;
+}
+
+WEC_TIME_T WEC_SpscCounterWindowTimeGet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime) {
+    WEC_TIME_T windowTime;
+    if (atomic_load_explicit(&counter->started, memory_order_relaxed)) {
+        counter->startTime = WEC_SpscStartTimeUpdate(counter, currentTime);
+        windowTime = currentTime - counter->startTime;
+    } else {
+        windowTime = counter->stopTime - counter->startTime;
+    }
+    return windowTime;
+}
+
+//
+// End of File
+//
@@ -0,0 +1,207 @@
+/**
+ * @file
+ * wec_spsc_counter.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Lock-free windowed event counter for one producer and one consumer.
+ *
+ * Events are added by a single producer, such as an interrupt or capture
+ * thread, while a single consumer queries the count.  The producer only ever
+ * advances the head of the event buffer and the consumer owns expiry and the
+ * tail, so the two sides never need a lock.  Requires C11 atomics.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ * SPSC - Single Producer Single Consumer
+ */
+
+#ifndef WEC_SPSC_COUNTER_H    // Guards against multiple inclusion
+#    define WEC_SPSC_COUNTER_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdatomic.h>
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Size of a cache line, used to keep producer and consumer data apart
+#    ifndef WEC_CACHE_LINE_SIZE
+#        define WEC_CACHE_LINE_SIZE (64U)
+#    endif
+
+//
+// Section: Data Types
+//
+
+/**
+ * Single producer single consumer windowed event counter instance.
+ * Treat the members as private and operate on them through the
+ * WEC_SpscCounter* APIs.
+ */
+typedef struct {
+    /// index of the position to add the next event.  Runs freely and is only
+    /// written by the producer.
+    _Alignas(WEC_CACHE_LINE_SIZE) _Atomic WEC_COUNT_T head;
+    /// index of the oldest event.  Runs freely and is only written by the
+    /// consumer.
+    _Alignas(WEC_CACHE_LINE_SIZE) _Atomic WEC_COUNT_T tail;
+    /// Stores the time of each event.  This line is read by the producer and
+    /// only written while the window is stopped.
+    _Alignas(WEC_CACHE_LINE_SIZE) WEC_TIME_T *eventBuffer;
+    /// Number of elements in eventBuffer, a power of two
+    WEC_COUNT_T capacity;
+    /// Indicates when window is started and running
+    atomic_bool started;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// Timestamp marking the start of the measurement window.  Written by
+    /// every consumer query, so it is kept off the lines the producer reads.
+    _Alignas(WEC_CACHE_LINE_SIZE) WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+} WEC_SpscCounter_T;
+
+//
+// Section: Producer APIs
+//
+
+/**
+ * Adds an event to the counter.
+ * May only be called from the producer.  The producer cannot remove events, so
+ * when the buffer is full the new event is dropped rather than the oldest.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when the buffer is full and the event was
+ * dropped.
+ */
+WEC_ERROR_T WEC_SpscCounterEventAdd(WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventTime);
+
+//
+// Section: Consumer APIs
+//
+
+/**
+ * Initializes a counter instance storing events in caller supplied memory.
+ * Must complete before the producer and consumer start using the counter.
+ * @param counter instance to initialize
+ * @param eventBuffer storage for event times, must outlive the counter
+ * @param capacity number of elements in eventBuffer, a power of two
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when eventBuffer or capacity cannot be used.
+ */
+WEC_ERROR_T WEC_SpscCounterInit(WEC_SpscCounter_T *counter,
+        WEC_TIME_T eventBuffer[], size_t capacity);
+
+/**
+ * Gets the current number of events.
+ * May only be called from the consumer.  Removes expired events and returns
+ * the count of remaining events.  Events the producer stamped later than
+ * currentTime are counted and never expired.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Count of events
+ */
+WEC_COUNT_T WEC_SpscCounterEventCountGet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Clears out all events added so far.
+ * May only be called from the consumer.
+ * @param counter instance to clear
+ */
+void WEC_SpscCounterEventsClear(WEC_SpscCounter_T *counter);
+
+/**
+ * Gets the value of the current window limit.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_SpscCounterWindowLimitGet(const WEC_SpscCounter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window.
+ * May only be called from the consumer.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @return error
+ */
+WEC_ERROR_T WEC_SpscCounterWindowLimitSet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Starts measurement
+ * May only be called from the consumer.
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_SpscCounterWindowStart(WEC_SpscCounter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement
+ * May only be called from the consumer.
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_SpscCounterWindowStop(WEC_SpscCounter_T *counter,
+        WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window
+ * May only be called from the consumer.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_SpscCounterWindowTimeGet(WEC_SpscCounter_T *counter,
+        WEC_TIME_T currentTime);
+
+#endif // WEC_SPSC_COUNTER_H
+
+//
+// End of File
+//
+
@@ -0,0 +1,286 @@
+/**
+ * @file
+ * wec_timer_wheel.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Hierarchical timer wheel expiring events of many counters in the background.
+ *
+ * Timers due within a lap of level 0 sit in the level 0 slot of their tick.
+ * Timers due further away sit in the slot of a coarser level covering their
+ * tick and cascade down a level each time the level below completes a lap,
+ * so every timer moves at most WEC_WHEEL_LEVELS times before it fires.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_timer_wheel.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <stddef.h>
+
+//
+// Section: Macros
+//
+#ifdef TEST
+#    define STATIC
+#else
+#    define STATIC static
+#endif
+
+//
+// Section: Constants
+//
+
+/// Smallest difference between two times taken to run backwards
+#define WEC_TIME_HALF ((WEC_TIME_T) (((WEC_TIME_T) ~(WEC_TIME_T) 0 / 2U) + 1U))
+
+/// Number of ticks covered by every level together
+#define WEC_WHEEL_SPAN (UINT64_C(1) << (WEC_WHEEL_LEVELS * WEC_WHEEL_SLOT_BITS))
+
+//
+// Section: Static Function Prototypes
+//
+
+/// Adds a timer to the slot covering its expiry time, at least minTicks after
+/// the current tick
+STATIC void WEC_WheelLink(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer,
+        uint64_t minTicks);
+
+/// Takes a timer out of its slot
+STATIC void WEC_WheelUnlink(WEC_WheelTimer_T *timer);
+
+/// Moves the timers of each coarser level slot reached by the current tick
+/// down the wheel
+STATIC void WEC_WheelCascade(WEC_TimerWheel_T *wheel);
+
+/// Expires the counters of the timers in the level 0 slot of the current tick
+STATIC size_t WEC_WheelSlotFire(WEC_TimerWheel_T *wheel,
+        WEC_TIME_T currentTime);
+
+//
+// Section: Static Function Definitions
+//
+
+STATIC void WEC_WheelLink(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer,
+        uint64_t minTicks) {
+    WEC_TIME_T delta = timer->expiryTime - wheel->time;
+    uint64_t ticks = 0U;
+    if (delta < WEC_TIME_HALF) { // Not yet due
+        ticks = (delta / wheel->resolution)
+                + ((0U != (delta % wheel->resolution)) ? 1U : 0U);
+    }
+    if (ticks < minTicks) {
+        ticks = minTicks;
+    }
+    if (WEC_WHEEL_SPAN <= ticks) {
+        ticks = WEC_WHEEL_SPAN - 1U; // Checked again once this far has passed
+    }
+
+    size_t level = 0U;
+    while (0U != (ticks >> ((level + 1U) * WEC_WHEEL_SLOT_BITS))) {
+        level++;
+    }
+    uint64_t expiryTick = wheel->tick + ticks;
+    size_t index = (size_t) (expiryTick >> (level * WEC_WHEEL_SLOT_BITS))
+            & (WEC_WHEEL_SLOTS - 1U);
+
+    WEC_WheelTimer_T **slot = &wheel->slots[level][index];
+    timer->slot = slot;
+    timer->previous = NULL;
+    timer->next = *slot;
+    if (NULL != *slot) {
+        (*slot)->previous = timer;
+    }
+    *slot = timer;
+}
+
+STATIC void WEC_WheelUnlink(WEC_WheelTimer_T *timer) {
+    if (NULL != timer->previous) {
+        timer->previous->next = timer->next;
+    } else {
+        *timer->slot = timer->next;
+    }
+    if (NULL != timer->next) {
+        timer->next->previous = timer->previous;
+    }
+    timer->slot = NULL;
+    timer->next = NULL;
+    timer->previous = NULL;
+}
+
+STATIC void WEC_WheelCascade(WEC_TimerWheel_T *wheel) {
+    for (size_t level = 1U; level < WEC_WHEEL_LEVELS; level++) {
+        size_t shift = level * WEC_WHEEL_SLOT_BITS;
+        if (0U != (wheel->tick & ((UINT64_C(1) << shift) - 1U))) {
+            break; // The level below has not completed a lap
+        }
+        size_t index = (size_t) (wheel->tick >> shift) & (WEC_WHEEL_SLOTS - 1U);
+        WEC_WheelTimer_T *timer = wheel->slots[level][index];
+        wheel->slots[level][index] = NULL;
+        while (NULL != timer) {
+            WEC_WheelTimer_T *next = timer->next;
+            // Timers due by now land in the level 0 slot fired next
+            WEC_WheelLink(wheel, timer, 0U);
+            timer = next;
+        }
+    }
+}
+
+STATIC size_t WEC_WheelSlotFire(WEC_TimerWheel_T *wheel,
+        WEC_TIME_T currentTime) {
+    size_t fired = 0U;
+    WEC_WheelTimer_T **slot =
+            &wheel->slots[0][wheel->tick & (WEC_WHEEL_SLOTS - 1U)];
+    // Outside of cascading, timers are linked at least a tick ahead, so
+    // neither rescheduling nor callbacks add to this slot
+    while (NULL != *slot) {
+        WEC_WheelTimer_T *timer = *slot;
+        WEC_WheelUnlink(timer);
+        wheel->timerCount--;
+        fired++;
+
+        WEC_COUNT_T count = WEC_CounterEventCountGet(timer->counter,
+                currentTime);
+        WEC_TIME_T oldestTime;
+        if (WEC_OKAY == WEC_CounterOldestTimeGet(timer->counter,
+                &oldestTime)) {
+            timer->expiryTime = oldestTime
+                    + WEC_CounterWindowLimitGet(timer->counter);
+            // A stopped counter does not expire events, leave it be
+            if ((WEC_TIME_T) (timer->expiryTime - currentTime - 1U)
+                    < WEC_TIME_HALF) {
+                WEC_WheelLink(wheel, timer, 1U);
+                wheel->timerCount++;
+            }
+        }
+        if (count != timer->count) {
+            timer->count = count;
+            if (NULL != wheel->callback) {
+                wheel->callback(timer, count, wheel->context);
+            }
+        }
+    }
+    return fired;
+}
+
+//
+// Section: APIs
+//
+
+WEC_ERROR_T WEC_TimerWheelInit(WEC_TimerWheel_T *wheel, WEC_TIME_T resolution,
+        WEC_TIME_T startTime, WEC_WheelCallback_T callback, void *context) {
+    assert(NULL != wheel);
+    if (0U == resolution) {
+        return WEC_ERROR;
+    }
+    for (size_t level = 0U; level < WEC_WHEEL_LEVELS; level++) {
+        for (size_t index = 0U; index < WEC_WHEEL_SLOTS; index++) {
+            wheel->slots[level][index] = NULL;
+        }
+    }
+    wheel->callback = callback;
+    wheel->context = context;
+    wheel->tick = 0U;
+    wheel->time = startTime;
+    wheel->resolution = resolution;
+    wheel->timerCount = 0U;
+    return WEC_OKAY;
+}
+
+void WEC_WheelTimerInit(WEC_WheelTimer_T *timer, WEC_Counter_T *counter) {
+    assert(NULL != timer);
+    timer->counter = counter;
+    timer->next = NULL;
+    timer->previous = NULL;
+    timer->slot = NULL;
+    timer->expiryTime = 0U;
+    timer->count = 0U;
+}
+
+void WEC_TimerWheelUpdate(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer,
+        WEC_TIME_T currentTime) {
+    timer->count = WEC_CounterEventCountGet(timer->counter, currentTime);
+    WEC_TIME_T oldestTime;
+    if (WEC_OKAY != WEC_CounterOldestTimeGet(timer->counter, &oldestTime)) {
+        WEC_TimerWheelRemove(wheel, timer);
+        return;
+    }
+    WEC_TIME_T expiryTime = oldestTime
+            + WEC_CounterWindowLimitGet(timer->counter);
+    if (NULL != timer->slot) {
+        if ((WEC_TIME_T) (expiryTime - timer->expiryTime) < WEC_TIME_HALF) {
+            return; // Firing early only reschedules the timer
+        }
+        WEC_WheelUnlink(timer);
+        wheel->timerCount--;
+    }
+    timer->expiryTime = expiryTime;
+    WEC_WheelLink(wheel, timer, 1U);
+    wheel->timerCount++;
+}
+
+void WEC_TimerWheelRemove(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer) {
+    if (NULL != timer->slot) {
+        WEC_WheelUnlink(timer);
+        wheel->timerCount--;
+    }
+}
+
+size_t WEC_TimerWheelAdvance(WEC_TimerWheel_T *wheel, WEC_TIME_T currentTime) {
+    size_t fired = 0U;
+    WEC_TIME_T elapsed = currentTime - wheel->time;
+    if (WEC_TIME_HALF <= elapsed) {
+        return 0U; // Time ran backwards
+    }
+    while (wheel->resolution <= elapsed) {
+        if (0U == wheel->timerCount) {
+            // Nothing to fire, skip straight to the last tick
+            WEC_TIME_T ticks = elapsed / wheel->resolution;
+            wheel->tick += ticks;
+            wheel->time += ticks * wheel->resolution;
+            break;
+        }
+        wheel->tick++;
+        wheel->time += wheel->resolution;
+        elapsed -= wheel->resolution;
+        WEC_WheelCascade(wheel);
+        fired += WEC_WheelSlotFire(wheel, currentTime);
+    }
+    return fired;
+}
+
+//
+// End of File
+//
+
@@ -0,0 +1,191 @@
+/**
+ * @file
+ * wec_timer_wheel.h
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Hierarchical timer wheel expiring events of many counters in the background.
+ *
+ * Counters only expire events when they are updated or queried, so after an
+ * idle period the next event pays for the whole backlog and the counts read
+ * by monitoring code go stale.  The wheel keeps a timer for each counter, due
+ * when the counter's oldest event expires, and advancing the wheel expires
+ * the due counters a few at a time, optionally reporting changed counts.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WEC_TIMER_WHEEL_H    // Guards against multiple inclusion
+#    define WEC_TIMER_WHEEL_H
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <stdbool.h>
+#    include <stddef.h>
+#    include <stdint.h>
+
+//
+// Section: Constants
+//
+
+/// Number of levels in the wheel
+#    define WEC_WHEEL_LEVELS (4U)
+
+/// Each level has 2^WEC_WHEEL_SLOT_BITS slots
+#    define WEC_WHEEL_SLOT_BITS (6U)
+
+/// Number of slots in each level
+#    define WEC_WHEEL_SLOTS (1U << WEC_WHEEL_SLOT_BITS)
+
+//
+// Section: Data Types
+//
+
+/**
+ * Timer tracking the next expiry of one counter.
+ * Treat the members as private.
+ */
+typedef struct WEC_WheelTimer_S {
+    /// Counter expired by the timer
+    WEC_Counter_T *counter;
+    /// Next timer in the same slot
+    struct WEC_WheelTimer_S *next;
+    /// Previous timer in the same slot
+    struct WEC_WheelTimer_S *previous;
+    /// Head of the list of the slot holding the timer, NULL when unscheduled
+    struct WEC_WheelTimer_S **slot;
+    /// Time at which the oldest event of the counter expires
+    WEC_TIME_T expiryTime;
+    /// Count of events when the timer was last updated or fired
+    WEC_COUNT_T count;
+} WEC_WheelTimer_T;
+
+/**
+ * Called when a timer fired and the count of its counter changed since the
+ * timer was last updated or fired.
+ * The callback may update or remove timers, but not advance the wheel.
+ * @param timer timer that fired
+ * @param count new count of events
+ * @param context pointer passed to WEC_TimerWheelInit()
+ */
+typedef void (*WEC_WheelCallback_T)(WEC_WheelTimer_T *timer, WEC_COUNT_T count,
+        void *context);
+
+/**
+ * Timer wheel instance.
+ * Treat the members as private and operate on them through the
+ * WEC_TimerWheel* APIs.
+ */
+typedef struct {
+    /// Lists of timers, level 0 slots are one tick apart and each slot of the
+    /// next level spans a full lap of the level below
+    WEC_WheelTimer_T *slots[WEC_WHEEL_LEVELS][WEC_WHEEL_SLOTS];
+    /// Called on count changes, may be NULL
+    WEC_WheelCallback_T callback;
+    /// Passed to callback
+    void *context;
+    /// Ticks elapsed since the wheel was initialized
+    uint64_t tick;
+    /// Time of the current tick
+    WEC_TIME_T time;
+    /// Length of a tick
+    WEC_TIME_T resolution;
+    /// Number of scheduled timers
+    size_t timerCount;
+} WEC_TimerWheel_T;
+
+//
+// Section: APIs
+//
+
+/**
+ * Initializes a timer wheel.
+ * Timers fire up to one resolution late.  Expiry times further away than
+ * 2^(WEC_WHEEL_LEVELS * WEC_WHEEL_SLOT_BITS) ticks are checked again once
+ * that far has passed.
+ * @param wheel instance to initialize
+ * @param resolution length of a tick
+ * @param startTime time of the first tick
+ * @param callback called on count changes, may be NULL
+ * @param context passed to callback
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when resolution is 0.
+ */
+WEC_ERROR_T WEC_TimerWheelInit(WEC_TimerWheel_T *wheel, WEC_TIME_T resolution,
+        WEC_TIME_T startTime, WEC_WheelCallback_T callback, void *context);
+
+/**
+ * Initializes a timer for a counter, unscheduled.
+ * @param timer instance to initialize
+ * @param counter counter expired by the timer, must outlive the timer
+ */
+void WEC_WheelTimerInit(WEC_WheelTimer_T *timer, WEC_Counter_T *counter);
+
+/**
+ * Schedules the timer of a counter for the expiry of its oldest event.
+ * Call after adding events to the counter.  Records the current count, which
+ * expires nothing when called right after an add, and costs nothing more
+ * while the timer is already scheduled and still due in time.
+ * @param wheel instance to update
+ * @param timer timer of the updated counter
+ * @param currentTime
+ */
+void WEC_TimerWheelUpdate(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer,
+        WEC_TIME_T currentTime);
+
+/**
+ * Removes a timer from the wheel.
+ * @param wheel instance to update
+ * @param timer timer to remove, may be unscheduled
+ */
+void WEC_TimerWheelRemove(WEC_TimerWheel_T *wheel, WEC_WheelTimer_T *timer);
+
+/**
+ * Advances the wheel, expiring the counters of every timer due by now.
+ * Each fired timer is scheduled again while its counter holds events.  The
+ * cost grows with the number of ticks passed while any timer is scheduled.
+ * @param wheel instance to advance
+ * @param currentTime
+ * @returns Number of timers fired
+ */
+size_t WEC_TimerWheelAdvance(WEC_TimerWheel_T *wheel, WEC_TIME_T currentTime);
+
+#endif // WEC_TIMER_WHEEL_H
+
+//
+// End of File
+//
+
@@ -46,6 +46,7 @@
 #include <stdint.h>
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
 
 //
 // Section: Macros
@@ -60,33 +61,59 @@
 // Section: Constants
 //
 
-//
-// Section: Global Variable Declarations
-//
+#if WEC_EVENT_BUFFER_MASKED
+/// Maps a free running index onto its slot in the event buffer
+#    define WEC_SLOT(counter, index) ((index) & ((counter)->capacity - 1U))
+#else
+/// Maps an index onto its slot in the event buffer
+#    define WEC_SLOT(counter, index) (index)
+#endif
+
+#if WEC_STATS_ENABLE
+/// Reads the tick counter timing expiry
+#    define WEC_STATS_TICKS_READ() WEC_STATS_TICKS()
+#else
+/// Statistics are disabled, so the tick counter is never read
+#    define WEC_STATS_TICKS_READ() ((uint64_t) 0U)
+#endif
+
+/// Serialized flag set when the window is started
+#define WEC_SERIAL_STARTED (0x01U)
 
-/// current count of events
-STATIC WEC_COUNT_T WEC_count;
+/// Serialized flag set when every event is followed by its weight
+#define WEC_SERIAL_WEIGHTED (0x02U)
 
-/// Indicates when window is started and running
-STATIC bool WEC_started;
+/// Number of bytes before the variable length values of a serialized counter
+#define WEC_SERIAL_HEADER_SIZE (5U)
 
-/// Timestamp marking the start of the measurement window
-STATIC WEC_TIME_T WEC_startTime;
+/// Ages at or beyond this are taken as times after the newest event
+#define WEC_TIME_HALF ((WEC_TIME_T) (((WEC_TIME_T) ~(WEC_TIME_T) 0 / 2U) + 1U))
 
-/// Timestamp marking the end of the measurement window
-STATIC WEC_TIME_T WEC_stopTime;
+/// Fails to compile when WEC_COUNT_T cannot count a full event buffer
+typedef char WEC_CountTypeHoldsBufferSize[
+        (WEC_EVENT_BUFFER_SIZE <= (WEC_COUNT_T) ~(WEC_COUNT_T) 0) ? 1 : -1];
+
+//
+// Section: Global Variable Declarations
+//
 
-/// Limit to the length of the time window
-STATIC WEC_TIME_T WEC_windowLimit;
+/// Event storage of the default counter instance
+STATIC WEC_TIME_T WEC_defaultEventBuffer[WEC_EVENT_BUFFER_SIZE];
 
-/// Stores the time of each event
-STATIC WEC_TIME_T WEC_eventBuffer[WEC_EVENT_BUFFER_SIZE];
+/// Event weight storage of the default counter instance
+STATIC WEC_WEIGHT_T WEC_defaultWeightBuffer[WEC_EVENT_BUFFER_SIZE];
 
-/// points to position to add the next event
-STATIC WEC_TIME_T *WEC_eventBufferHead = WEC_eventBuffer;
+/// Optional features of the default counter instance
+STATIC WEC_CounterExtensions_T WEC_defaultExtensions;
 
-/// points to oldest event
-STATIC WEC_TIME_T *WEC_eventBufferTail = WEC_eventBuffer;
+/// Counter instance operated on by the global API
+STATIC WEC_Counter_T WEC_defaultCounter = {
+    .eventBuffer = WEC_defaultEventBuffer,
+    .weightBuffer = WEC_defaultWeightBuffer,
+    .extensions = &WEC_defaultExtensions,
+    .capacity = WEC_EVENT_BUFFER_SIZE,
+    .capacityLimit = WEC_EVENT_BUFFER_SIZE,
+};
 
 //
 // Section: Macros
@@ -96,89 +123,674 @@ STATIC WEC_TIME_T *WEC_eventBufferTail = WEC_eventBuffer;
 // Section: Static Function Prototypes
 //
 
-/// Appends new event time stamp to the event queue
-STATIC void WEC_EventEnqueue(WEC_TIME_T eventTime);
+/// Appends new event time stamp and weight to the event queue, leaving the
+/// statistics to the caller
+STATIC void WEC_EventEnqueue(WEC_Counter_T *counter, WEC_TIME_T eventTime,
+        WEC_WEIGHT_T weight);
+
+/// Adds an event, inserting it in order when it arrives late
+STATIC WEC_ERROR_T WEC_EventRecord(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight);
+
+/// Gets how much older an event is than the newest event, 0 when it is not
+/// older
+STATIC WEC_TIME_T WEC_EventLatenessGet(const WEC_Counter_T *counter,
+        WEC_TIME_T eventTime);
+
+/// Inserts an event older than the newest event in order
+STATIC WEC_ERROR_T WEC_EventLateInsert(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight, WEC_TIME_T lateness);
+
+/// Removes events equal to or older than the window limit in O(log n)
+STATIC void WEC_EventExpire(WEC_Counter_T *counter, WEC_TIME_T currentTime);
+
+/// Counts the newest events that are less than ageLimit older than newestTime
+STATIC WEC_COUNT_T WEC_EventsYoungerCount(const WEC_Counter_T *counter,
+        WEC_TIME_T newestTime, WEC_TIME_T ageLimit);
+
+/// Raises and clears the alarms of thresholds crossed by the count
+STATIC void WEC_ThresholdsCheck(WEC_Counter_T *counter);
+
+/// Appends a gap to a queue, first dropping the newer gaps it outranks
+STATIC void WEC_GapQueuePush(WEC_GapQueue_T *queue, WEC_COUNT_T capacity,
+        WEC_GapEntry_T entry, bool smallest);
+
+/// Drops the oldest gap of a queue when it is the gap ending at sequence
+STATIC void WEC_GapQueueExpire(WEC_GapQueue_T *queue, WEC_COUNT_T capacity,
+        WEC_COUNT_T sequence);
+
+/// Tracks a new newest event and the gap after previousTime, NULL for none
+STATIC void WEC_GapsEventAdd(WEC_GapTracker_T *gaps,
+        const WEC_TIME_T *previousTime, WEC_TIME_T eventTime);
+
+/// Stops tracking the gaps after the oldest events about to be removed
+STATIC void WEC_GapsOldestRemove(WEC_Counter_T *counter,
+        WEC_COUNT_T removeCount);
+
+/// Forgets every gap
+STATIC void WEC_GapsClear(WEC_GapTracker_T *gaps);
 
-/// Removes events equal to or older than the window limit
-STATIC void WEC_EventExpire(WEC_TIME_T currentTime);
+/// Tracks every stored event from scratch
+STATIC void WEC_GapsRebuild(WEC_Counter_T *counter);
+
+/// Gets the gap tracker of a counter, NULL when gaps are not tracked
+STATIC WEC_GapTracker_T *WEC_GapsGet(const WEC_Counter_T *counter);
+
+/// Gets the allocator of a counter, NULL for caller storage
+STATIC const WEC_Allocator_T *WEC_AllocatorGet(const WEC_Counter_T *counter);
 
 /// Remove oldest event in the queue
-STATIC void WEC_EventOldestRemove(void);
+STATIC void WEC_EventOldestRemove(WEC_Counter_T *counter);
+
+/// Removes a number of the oldest events in the queue
+STATIC void WEC_EventsOldestRemove(WEC_Counter_T *counter,
+        WEC_COUNT_T removeCount);
+
+/// Checks and handles overflow condition by growing the buffer or, when it
+/// cannot grow, removing oldest event
+WEC_ERROR_T WEC_OverflowCheck(WEC_Counter_T *counter);
+
+/// Grows an allocated buffer to hold at least the needed number of events
+STATIC WEC_ERROR_T WEC_BufferGrow(WEC_Counter_T *counter, size_t needed);
+
+/// Checks that an event buffer capacity can be indexed
+STATIC bool WEC_CapacityValid(size_t capacity);
+
+/// Increments indices around the circular buffer
+STATIC WEC_COUNT_T WEC_IndexIncrement(const WEC_Counter_T *counter,
+        WEC_COUNT_T index);
+
+/// Advances indices around the circular buffer by up to a full lap
+STATIC WEC_COUNT_T WEC_IndexAdvance(const WEC_Counter_T *counter,
+        WEC_COUNT_T index, WEC_COUNT_T steps);
+
+/// Copies event time stamps to the head of the event queue
+STATIC void WEC_EventsEnqueue(WEC_Counter_T *counter,
+        const WEC_TIME_T eventTimes[], WEC_COUNT_T eventCount);
+
+/// Records added events and the occupancy they reach in the statistics
+STATIC void WEC_StatsAddRecord(WEC_Counter_T *counter, size_t addCount);
+
+/// Records events dropped from a full buffer in the statistics
+STATIC void WEC_StatsOverflowRecord(WEC_Counter_T *counter, size_t dropCount);
+
+/// Records events removed by one expiry in the statistics
+STATIC void WEC_StatsExpiryRecord(WEC_Counter_T *counter, size_t expireCount,
+        uint64_t startTicks);
 
-/// Checks and handles overflow condition by removing oldest event
-WEC_ERROR_T WEC_OverflowCheck(void);
+/// Appends a variable length encoded value to a buffer, 7 bits per byte with
+/// the high bit set on every byte but the last
+STATIC bool WEC_VarintWrite(uint8_t buffer[], size_t bufferSize,
+        size_t *offset, uint64_t value);
 
-/// Increments pointers around the circular buffer
-STATIC WEC_TIME_T *WEC_PtrIncrement(WEC_TIME_T ptr[]);
+/// Reads a variable length encoded value from a buffer
+STATIC bool WEC_VarintRead(const uint8_t buffer[], size_t bufferSize,
+        size_t *offset, uint64_t *value);
 
 /// Updates the start time based on the window limit and current time
-STATIC WEC_TIME_T WEC_StartTimeUpdate(WEC_TIME_T currentTime);
+STATIC WEC_TIME_T WEC_StartTimeUpdate(const WEC_Counter_T *counter,
+        WEC_TIME_T currentTime);
 
 /**
  * Shifts the detection window in time based on the current time passed in and
  * the window limit.
+ * @param counter
  * @param currentTime
  */
-STATIC WEC_ERROR_T WEC_WindowShift(WEC_TIME_T currentTime);
+STATIC WEC_ERROR_T WEC_WindowShift(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime);
 
 //
 // Section: Static Function Definitions
 //
 
-STATIC void WEC_EventEnqueue(WEC_TIME_T eventTime) {
-    WEC_count++;
-    *WEC_eventBufferHead = eventTime;
-    WEC_eventBufferHead = WEC_PtrIncrement(WEC_eventBufferHead);
+STATIC void WEC_EventEnqueue(WEC_Counter_T *counter, WEC_TIME_T eventTime,
+        WEC_WEIGHT_T weight) {
+    WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    if (NULL != gaps) {
+        const WEC_TIME_T *newestTime = NULL;
+        if (0U < counter->count) {
+            newestTime = &counter->eventBuffer[WEC_SLOT(counter,
+                    WEC_IndexAdvance(counter, counter->tail,
+                    counter->count - 1U))];
+        }
+        WEC_GapsEventAdd(gaps, newestTime, eventTime);
+    }
+    counter->count++;
+    counter->eventBuffer[WEC_SLOT(counter, counter->head)] = eventTime;
+    if (NULL != counter->weightBuffer) {
+        counter->addedWeight += weight;
+        counter->weightBuffer[WEC_SLOT(counter, counter->head)] =
+                counter->addedWeight;
+    }
+    counter->head = WEC_IndexIncrement(counter, counter->head);
 }
 
-STATIC void WEC_EventExpire(WEC_TIME_T currentTime) {
-    while (WEC_count) {
-        WEC_TIME_T oldestEvent = *WEC_eventBufferTail;
-        if (currentTime - oldestEvent < WEC_windowLimit) {
-            break;
+STATIC WEC_ERROR_T WEC_EventRecord(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight) {
+    if ((0U != counter->latenessLimit) && (0U < counter->count)) {
+        WEC_TIME_T lateness = WEC_EventLatenessGet(counter, eventTime);
+        if (0U != lateness) {
+            return WEC_EventLateInsert(counter, eventTime, weight, lateness);
+        }
+    }
+    if (WEC_NOT_STARTED == WEC_WindowShift(counter, eventTime)) {
+        return WEC_NOT_STARTED;
+    }
+    WEC_ERROR_T overflowResult = WEC_OverflowCheck(counter);
+    WEC_EventEnqueue(counter, eventTime, weight);
+    WEC_StatsAddRecord(counter, 1U);
+    WEC_ThresholdsCheck(counter);
+    return overflowResult;
+}
+
+STATIC WEC_TIME_T WEC_EventLatenessGet(const WEC_Counter_T *counter,
+        WEC_TIME_T eventTime) {
+    WEC_COUNT_T newest = WEC_IndexAdvance(counter, counter->tail,
+            counter->count - 1U);
+    WEC_TIME_T lateness = counter->eventBuffer[WEC_SLOT(counter, newest)]
+            - eventTime;
+    return (lateness < WEC_TIME_HALF) ? lateness : 0U;
+}
+
+STATIC WEC_ERROR_T WEC_EventLateInsert(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight, WEC_TIME_T lateness) {
+    if (false == counter->started) {
+        return WEC_NOT_STARTED;
+    }
+    if (counter->latenessLimit < lateness) {
+        return WEC_EVENT_TOO_LATE;
+    }
+    if (counter->windowLimit <= lateness) {
+        // Already left the window, so it is added and expires at once
+        WEC_StatsAddRecord(counter, 1U);
+        WEC_StatsExpiryRecord(counter, 1U, WEC_STATS_TICKS_READ());
+        return WEC_OKAY;
+    }
+    WEC_TIME_T newestTime = eventTime + lateness;
+
+    // Binary search for the first event newer than the late one
+    WEC_COUNT_T low = 0U;
+    WEC_COUNT_T high = counter->count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T index = WEC_IndexAdvance(counter, counter->tail, mid);
+        WEC_TIME_T age = newestTime
+                - counter->eventBuffer[WEC_SLOT(counter, index)];
+        if (age < lateness) {
+            high = mid;
+        } else {
+            low = mid + 1U;
+        }
+    }
+
+    // A full buffer keeps its newest events, which drops the late event
+    // itself when it is older than all of them
+    if ((counter->capacity <= counter->count) && (0U == low)
+            && (WEC_OKAY != WEC_BufferGrow(counter, counter->count + 1U))) {
+        WEC_StatsAddRecord(counter, 1U);
+        WEC_StatsOverflowRecord(counter, 1U);
+        return WEC_BUFFER_OVERFLOW;
+    }
+    WEC_ERROR_T overflowResult = WEC_OverflowCheck(counter);
+    if (WEC_BUFFER_OVERFLOW == overflowResult) {
+        low--; // The oldest event was removed from in front of it
+    }
+
+    // Shift the newer events up by one, they are few when lateness is small
+    WEC_COUNT_T to = counter->head;
+    for (WEC_COUNT_T i = counter->count; i > low; i--) {
+        WEC_COUNT_T from = WEC_IndexAdvance(counter, counter->tail, i - 1U);
+        counter->eventBuffer[WEC_SLOT(counter, to)] =
+                counter->eventBuffer[WEC_SLOT(counter, from)];
+        if (NULL != counter->weightBuffer) {
+            counter->weightBuffer[WEC_SLOT(counter, to)] =
+                    counter->weightBuffer[WEC_SLOT(counter, from)] + weight;
+        }
+        to = from;
+    }
+    counter->eventBuffer[WEC_SLOT(counter, to)] = eventTime;
+    if (NULL != counter->weightBuffer) {
+        WEC_WEIGHT_T before = counter->removedWeight;
+        if (0U < low) {
+            before = counter->weightBuffer[WEC_SLOT(counter,
+                    WEC_IndexAdvance(counter, counter->tail, low - 1U))];
+        }
+        counter->weightBuffer[WEC_SLOT(counter, to)] = before + weight;
+        counter->addedWeight += weight;
+    }
+    counter->count++;
+    counter->head = WEC_IndexIncrement(counter, counter->head);
+    WEC_StatsAddRecord(counter, 1U);
+    if (NULL != WEC_GapsGet(counter)) {
+        WEC_GapsRebuild(counter); // Splits a gap in the middle of the queues
+    }
+    WEC_ThresholdsCheck(counter);
+    return overflowResult;
+}
+
+STATIC void WEC_EventExpire(WEC_Counter_T *counter, WEC_TIME_T currentTime) {
+    if ((0U == counter->count)
+            || ((WEC_TIME_T) (currentTime
+            - counter->eventBuffer[WEC_SLOT(counter, counter->tail)])
+            < counter->windowLimit)) {
+        return; // Nothing to expire
+    }
+    uint64_t startTicks = WEC_STATS_TICKS_READ();
+
+    // Events are stored oldest first, so the ages measured from currentTime
+    // only decrease from tail to head, even when the time stamps themselves
+    // wrap around.  Binary search for the first event still in the window.
+    WEC_COUNT_T low = 1U;
+    WEC_COUNT_T high = counter->count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T index = WEC_IndexAdvance(counter, counter->tail, mid);
+        WEC_TIME_T event = counter->eventBuffer[WEC_SLOT(counter, index)];
+        if ((WEC_TIME_T) (currentTime - event) < counter->windowLimit) {
+            high = mid;
+        } else {
+            low = mid + 1U;
+        }
+    }
+    WEC_EventsOldestRemove(counter, low);
+    WEC_StatsExpiryRecord(counter, low, startTicks);
+    WEC_ThresholdsCheck(counter);
+}
+
+STATIC WEC_COUNT_T WEC_EventsYoungerCount(const WEC_Counter_T *counter,
+        WEC_TIME_T newestTime, WEC_TIME_T ageLimit) {
+    // Ages only decrease from tail to head, as in WEC_EventExpire()
+    WEC_COUNT_T low = 0U;
+    WEC_COUNT_T high = counter->count;
+    while (low < high) {
+        WEC_COUNT_T mid = low + ((high - low) / 2U);
+        WEC_COUNT_T index = WEC_IndexAdvance(counter, counter->tail, mid);
+        WEC_TIME_T event = counter->eventBuffer[WEC_SLOT(counter, index)];
+        if ((WEC_TIME_T) (newestTime - event) < ageLimit) {
+            high = mid;
         } else {
-            WEC_EventOldestRemove();
+            low = mid + 1U;
         }
     }
+    return counter->count - low;
 }
 
-STATIC void WEC_EventOldestRemove(void) {
-    WEC_count--;
-    WEC_eventBufferTail = WEC_PtrIncrement(WEC_eventBufferTail);
+STATIC void WEC_ThresholdsCheck(WEC_Counter_T *counter) {
+    if (NULL == counter->extensions) {
+        return;
+    }
+    WEC_Threshold_T *threshold = counter->extensions->thresholds;
+    while (NULL != threshold) {
+        // Callbacks may remove the threshold they are passed
+        WEC_Threshold_T *next = threshold->next;
+        if ((false == threshold->above)
+                && (threshold->upper <= counter->count)) {
+            threshold->above = true;
+            threshold->callback(threshold, true, counter->count,
+                    threshold->context);
+        } else if ((true == threshold->above)
+                && (counter->count <= threshold->lower)) {
+            threshold->above = false;
+            threshold->callback(threshold, false, counter->count,
+                    threshold->context);
+        }
+        threshold = next;
+    }
 }
 
-WEC_ERROR_T WEC_OverflowCheck(void) {
-    if (WEC_EVENT_BUFFER_SIZE <= WEC_count) {
-        WEC_EventOldestRemove(); // Buffer overflow
+STATIC void WEC_GapQueuePush(WEC_GapQueue_T *queue, WEC_COUNT_T capacity,
+        WEC_GapEntry_T entry, bool smallest) {
+    // Older gaps that are no smaller (or larger) than the new one leave the
+    // window first, so they can never be the answer again
+    while (0U < queue->count) {
+        WEC_COUNT_T back = queue->head + queue->count - 1U;
+        if (back >= capacity) {
+            back -= capacity;
+        }
+        WEC_TIME_T gap = queue->entries[back].gap;
+        if (smallest ? (gap < entry.gap) : (gap > entry.gap)) {
+            break;
+        }
+        queue->count--;
+    }
+    WEC_COUNT_T index = queue->head + queue->count;
+    if (index >= capacity) {
+        index -= capacity;
+    }
+    queue->entries[index] = entry;
+    queue->count++;
+}
+
+STATIC void WEC_GapQueueExpire(WEC_GapQueue_T *queue, WEC_COUNT_T capacity,
+        WEC_COUNT_T sequence) {
+    if ((0U < queue->count)
+            && (sequence == queue->entries[queue->head].sequence)) {
+        queue->head++;
+        if (queue->head >= capacity) {
+            queue->head = 0U;
+        }
+        queue->count--;
+    }
+}
+
+STATIC void WEC_GapsEventAdd(WEC_GapTracker_T *gaps,
+        const WEC_TIME_T *previousTime, WEC_TIME_T eventTime) {
+    if (NULL != previousTime) {
+        WEC_GapEntry_T entry = {
+            .gap = eventTime - *previousTime,
+            .sequence = gaps->sequence,
+        };
+        WEC_GapQueuePush(&gaps->minQueue, gaps->capacity, entry, true);
+        WEC_GapQueuePush(&gaps->maxQueue, gaps->capacity, entry, false);
+        gaps->squareSum += (uint64_t) entry.gap * entry.gap;
+    }
+    gaps->sequence++;
+}
+
+STATIC void WEC_GapsOldestRemove(WEC_Counter_T *counter,
+        WEC_COUNT_T removeCount) {
+    WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    WEC_COUNT_T sequence = gaps->sequence - counter->count;
+    WEC_COUNT_T index = counter->tail;
+    // The newest event has no gap after it
+    for (WEC_COUNT_T i = 0U; (i < removeCount) && (i + 1U < counter->count);
+            i++) {
+        WEC_COUNT_T next = WEC_IndexIncrement(counter, index);
+        WEC_TIME_T gap = counter->eventBuffer[WEC_SLOT(counter, next)]
+                - counter->eventBuffer[WEC_SLOT(counter, index)];
+        sequence++;
+        WEC_GapQueueExpire(&gaps->minQueue, gaps->capacity, sequence);
+        WEC_GapQueueExpire(&gaps->maxQueue, gaps->capacity, sequence);
+        gaps->squareSum -= (uint64_t) gap * gap;
+        index = next;
+    }
+}
+
+STATIC void WEC_GapsClear(WEC_GapTracker_T *gaps) {
+    gaps->minQueue.head = 0U;
+    gaps->minQueue.count = 0U;
+    gaps->maxQueue.head = 0U;
+    gaps->maxQueue.count = 0U;
+    gaps->squareSum = 0U;
+}
+
+STATIC void WEC_GapsRebuild(WEC_Counter_T *counter) {
+    WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    WEC_GapsClear(gaps);
+    gaps->sequence = 0U;
+    const WEC_TIME_T *previousTime = NULL;
+    WEC_COUNT_T index = counter->tail;
+    for (WEC_COUNT_T i = 0U; i < counter->count; i++) {
+        const WEC_TIME_T *eventTime =
+                &counter->eventBuffer[WEC_SLOT(counter, index)];
+        WEC_GapsEventAdd(gaps, previousTime, *eventTime);
+        previousTime = eventTime;
+        index = WEC_IndexIncrement(counter, index);
+    }
+}
+
+STATIC WEC_GapTracker_T *WEC_GapsGet(const WEC_Counter_T *counter) {
+    return (NULL != counter->extensions) ? counter->extensions->gaps : NULL;
+}
+
+STATIC const WEC_Allocator_T *WEC_AllocatorGet(const WEC_Counter_T *counter) {
+    return (NULL != counter->extensions) ? counter->extensions->allocator
+            : NULL;
+}
+
+STATIC void WEC_EventOldestRemove(WEC_Counter_T *counter) {
+    WEC_EventsOldestRemove(counter, 1U);
+}
+
+STATIC void WEC_EventsOldestRemove(WEC_Counter_T *counter,
+        WEC_COUNT_T removeCount) {
+    if (NULL != WEC_GapsGet(counter)) {
+        WEC_GapsOldestRemove(counter, removeCount);
+    }
+    WEC_COUNT_T newestRemoved = WEC_IndexAdvance(counter, counter->tail,
+            removeCount - 1U);
+    if (NULL != counter->weightBuffer) {
+        // Running totals make the weight of any run of events one subtraction
+        counter->removedWeight =
+                counter->weightBuffer[WEC_SLOT(counter, newestRemoved)];
+    }
+    counter->count -= removeCount;
+    counter->tail = WEC_IndexIncrement(counter, newestRemoved);
+}
+
+WEC_ERROR_T WEC_OverflowCheck(WEC_Counter_T *counter) {
+    if (counter->capacity <= counter->count) {
+        if (WEC_OKAY == WEC_BufferGrow(counter, counter->count + 1U)) {
+            return WEC_OKAY;
+        }
+        WEC_EventOldestRemove(counter); // Buffer overflow
+        WEC_StatsOverflowRecord(counter, 1U);
+        return WEC_BUFFER_OVERFLOW;
+    }
+    return WEC_OKAY;
+}
+
+STATIC WEC_ERROR_T WEC_BufferGrow(WEC_Counter_T *counter, size_t needed) {
+    const WEC_Allocator_T *allocator = WEC_AllocatorGet(counter);
+    if ((NULL == allocator) || (counter->capacity >= counter->capacityLimit)) {
+        return WEC_BUFFER_OVERFLOW;
+    }
+
+    size_t capacity = counter->capacity;
+    while ((capacity < needed) && (capacity < counter->capacityLimit)) {
+        capacity *= 2U;
+    }
+    if (capacity > counter->capacityLimit) {
+        capacity = counter->capacityLimit;
+    }
+    WEC_TIME_T *eventBuffer = allocator->allocate(allocator->context,
+            capacity * sizeof (WEC_TIME_T));
+    if (NULL == eventBuffer) {
         return WEC_BUFFER_OVERFLOW;
     }
+
+    // Unwrap the events onto the start of the new buffer
+    WEC_COUNT_T tailSlot = WEC_SLOT(counter, counter->tail);
+    WEC_COUNT_T firstSegment = counter->capacity - tailSlot;
+    if (firstSegment > counter->count) {
+        firstSegment = counter->count;
+    }
+    memcpy(eventBuffer, &counter->eventBuffer[tailSlot],
+            firstSegment * sizeof (WEC_TIME_T));
+    memcpy(&eventBuffer[firstSegment], counter->eventBuffer,
+            (counter->count - firstSegment) * sizeof (WEC_TIME_T));
+    allocator->release(allocator->context, counter->eventBuffer,
+            counter->capacity * sizeof (WEC_TIME_T));
+
+    counter->eventBuffer = eventBuffer;
+    counter->capacity = (WEC_COUNT_T) capacity;
+    counter->tail = 0U;
+    counter->head = counter->count;
     return WEC_OKAY;
 }
 
-STATIC WEC_TIME_T * WEC_PtrIncrement(WEC_TIME_T arrayPtr[]) {
-    WEC_TIME_T * const eventBufferLastElement = WEC_eventBuffer + WEC_EVENT_BUFFER_SIZE - 1;
-    if (eventBufferLastElement > arrayPtr) {
-        arrayPtr++;
+STATIC bool WEC_CapacityValid(size_t capacity) {
+    if ((0U == capacity) || ((WEC_COUNT_T) capacity != capacity)) {
+        return false;
+    }
+#if WEC_EVENT_BUFFER_MASKED
+    return 0U == (capacity & (capacity - 1U));
+#else
+    return true;
+#endif
+}
+
+#if WEC_EVENT_BUFFER_MASKED
+
+STATIC WEC_COUNT_T WEC_IndexIncrement(const WEC_Counter_T *counter,
+        WEC_COUNT_T index) {
+    (void) counter;
+    return index + 1U;
+}
+
+STATIC WEC_COUNT_T WEC_IndexAdvance(const WEC_Counter_T *counter,
+        WEC_COUNT_T index, WEC_COUNT_T steps) {
+    (void) counter;
+    return index + steps;
+}
+
+#else
+
+STATIC WEC_COUNT_T WEC_IndexIncrement(const WEC_Counter_T *counter,
+        WEC_COUNT_T index) {
+    if ((counter->capacity - 1U) > index) {
+        index++;
+    } else {
+        index = 0U;
+    }
+    return index;
+}
+
+STATIC WEC_COUNT_T WEC_IndexAdvance(const WEC_Counter_T *counter,
+        WEC_COUNT_T index, WEC_COUNT_T steps) {
+    WEC_COUNT_T roomBeforeWrap = counter->capacity - index;
+    if (roomBeforeWrap > steps) {
+        index += steps;
     } else {
-        arrayPtr = WEC_eventBuffer;
+        index = steps - roomBeforeWrap;
+    }
+    return index;
+}
+
+#endif
+
+STATIC void WEC_EventsEnqueue(WEC_Counter_T *counter,
+        const WEC_TIME_T eventTimes[], WEC_COUNT_T eventCount) {
+    WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    if (NULL != gaps) {
+        const WEC_TIME_T *previousTime = NULL;
+        if (0U < counter->count) {
+            previousTime = &counter->eventBuffer[WEC_SLOT(counter,
+                    WEC_IndexAdvance(counter, counter->tail,
+                    counter->count - 1U))];
+        }
+        for (WEC_COUNT_T i = 0U; i < eventCount; i++) {
+            WEC_GapsEventAdd(gaps, previousTime, eventTimes[i]);
+            previousTime = &eventTimes[i];
+        }
+    }
+    WEC_COUNT_T headSlot = WEC_SLOT(counter, counter->head);
+    WEC_COUNT_T firstSegment = counter->capacity - headSlot;
+    if (firstSegment > eventCount) {
+        firstSegment = eventCount;
+    }
+    memcpy(&counter->eventBuffer[headSlot], eventTimes,
+            firstSegment * sizeof (WEC_TIME_T));
+    memcpy(&counter->eventBuffer[0], &eventTimes[firstSegment],
+            (eventCount - firstSegment) * sizeof (WEC_TIME_T));
+    if (NULL != counter->weightBuffer) {
+        WEC_COUNT_T index = counter->head;
+        for (WEC_COUNT_T i = 0U; i < eventCount; i++) {
+            counter->addedWeight++;
+            counter->weightBuffer[WEC_SLOT(counter, index)] =
+                    counter->addedWeight;
+            index = WEC_IndexIncrement(counter, index);
+        }
+    }
+    counter->count += eventCount;
+    counter->head = WEC_IndexAdvance(counter, counter->head, eventCount);
+}
+
+#if WEC_STATS_ENABLE
+
+STATIC void WEC_StatsAddRecord(WEC_Counter_T *counter, size_t addCount) {
+    counter->stats.adds += addCount;
+    if (counter->stats.countPeak < counter->count) {
+        counter->stats.countPeak = counter->count;
+    }
+}
+
+STATIC void WEC_StatsOverflowRecord(WEC_Counter_T *counter, size_t dropCount) {
+    counter->stats.overflows += dropCount;
+}
+
+STATIC void WEC_StatsExpiryRecord(WEC_Counter_T *counter, size_t expireCount,
+        uint64_t startTicks) {
+    counter->stats.expirations += expireCount;
+    counter->stats.expiryTicks += WEC_STATS_TICKS_READ() - startTicks;
+    if (counter->stats.expiryBatchMax < expireCount) {
+        counter->stats.expiryBatchMax = expireCount;
     }
-    return arrayPtr;
 }
 
-STATIC WEC_TIME_T WEC_StartTimeUpdate(WEC_TIME_T currentTime) {
+#else
+
+STATIC void WEC_StatsAddRecord(WEC_Counter_T *counter, size_t addCount) {
+    (void) counter;
+    (void) addCount;
+}
+
+STATIC void WEC_StatsOverflowRecord(WEC_Counter_T *counter, size_t dropCount) {
+    (void) counter;
+    (void) dropCount;
+}
+
+STATIC void WEC_StatsExpiryRecord(WEC_Counter_T *counter, size_t expireCount,
+        uint64_t startTicks) {
+    (void) counter;
+    (void) expireCount;
+    (void) startTicks;
+}
+
+#endif
+
+STATIC bool WEC_VarintWrite(uint8_t buffer[], size_t bufferSize,
+        size_t *offset, uint64_t value) {
+    size_t index = *offset;
+    do {
+        if (bufferSize <= index) {
+            return false;
+        }
+        uint8_t byte = (uint8_t) (value & 0x7FU);
+        value >>= 7U;
+        buffer[index++] = (0U != value) ? (byte | 0x80U) : byte;
+    } while (0U != value);
+    *offset = index;
+    return true;
+}
+
+STATIC bool WEC_VarintRead(const uint8_t buffer[], size_t bufferSize,
+        size_t *offset, uint64_t *value) {
+    size_t index = *offset;
+    uint64_t result = 0U;
+    for (unsigned int shift = 0U; shift < 64U; shift += 7U) {
+        if (bufferSize <= index) {
+            return false;
+        }
+        uint8_t byte = buffer[index++];
+        result |= (uint64_t) (byte & 0x7FU) << shift;
+        if (0U == (byte & 0x80U)) {
+            *offset = index;
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+STATIC WEC_TIME_T WEC_StartTimeUpdate(const WEC_Counter_T *counter,
+        WEC_TIME_T currentTime) {
     WEC_TIME_T newStart;
-    if ((currentTime - WEC_startTime) >= WEC_windowLimit) {
-        newStart = currentTime - WEC_windowLimit;
+    if ((WEC_TIME_T) (currentTime - counter->startTime)
+            >= counter->windowLimit) {
+        newStart = currentTime - counter->windowLimit;
     } else {
-        newStart = WEC_startTime;
+        newStart = counter->startTime;
     }
     return newStart;
 }
 
-STATIC WEC_ERROR_T WEC_WindowShift(WEC_TIME_T eventTime) {
-    if (true == WEC_started) {
-        WEC_startTime = WEC_StartTimeUpdate(eventTime);
-        WEC_EventExpire(eventTime);
+STATIC WEC_ERROR_T WEC_WindowShift(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime) {
+    if (true == counter->started) {
+        counter->startTime = WEC_StartTimeUpdate(counter, eventTime);
+        WEC_EventExpire(counter, eventTime);
         return WEC_OKAY;
     }
     return WEC_NOT_STARTED;
@@ -189,36 +801,617 @@ STATIC WEC_ERROR_T WEC_WindowShift(WEC_TIME_T eventTime) {
 //
 
 WEC_ERROR_T WEC_EventAdd(WEC_TIME_T eventTime) {
-    if (WEC_NOT_STARTED == WEC_WindowShift(eventTime)) {
-        return WEC_NOT_STARTED;
-    }
-    WEC_ERROR_T overflowResult = WEC_OverflowCheck();
-    WEC_EventEnqueue(eventTime);
-    return overflowResult;
+    return WEC_CounterEventAdd(&WEC_defaultCounter, eventTime);
+}
+
+WEC_ERROR_T WEC_EventTryAdd(WEC_TIME_T eventTime, WEC_COUNT_T limit,
+        WEC_TIME_T *waitTime) {
+    return WEC_CounterEventTryAdd(&WEC_defaultCounter, eventTime, limit,
+            waitTime);
+}
+
+WEC_ERROR_T WEC_EventAddBatch(const WEC_TIME_T eventTimes[], size_t eventCount,
+        size_t *overflowCount) {
+    return WEC_CounterEventAddBatch(&WEC_defaultCounter, eventTimes, eventCount,
+            overflowCount);
+}
+
+WEC_ERROR_T WEC_EventAddWeighted(WEC_TIME_T eventTime, WEC_WEIGHT_T weight) {
+    return WEC_CounterEventAddWeighted(&WEC_defaultCounter, eventTime, weight);
 }
 
 WEC_COUNT_T WEC_EventCountGet(WEC_TIME_T currentTime) {
-    (void) WEC_WindowShift(currentTime);
-    return WEC_count;
+    return WEC_CounterEventCountGet(&WEC_defaultCounter, currentTime);
+}
+
+WEC_WEIGHT_T WEC_EventSumGet(WEC_TIME_T currentTime) {
+    return WEC_CounterEventSumGet(&WEC_defaultCounter, currentTime);
+}
+
+WEC_COUNT_T WEC_EventCountRange(WEC_TIME_T startTime, WEC_TIME_T endTime) {
+    return WEC_CounterEventCountRange(&WEC_defaultCounter, startTime, endTime);
+}
+
+WEC_ERROR_T WEC_OldestTimeGet(WEC_TIME_T *oldestTime) {
+    return WEC_CounterOldestTimeGet(&WEC_defaultCounter, oldestTime);
 }
 
 void WEC_EventsClear(void) {
-    WEC_count = 0;
-    WEC_eventBufferHead = WEC_eventBuffer;
-    WEC_eventBufferTail = WEC_eventBuffer;
+    WEC_CounterEventsClear(&WEC_defaultCounter);
+}
+
+WEC_ERROR_T WEC_Serialize(uint8_t buffer[], size_t bufferSize, size_t *length) {
+    return WEC_CounterSerialize(&WEC_defaultCounter, buffer, bufferSize,
+            length);
+}
+
+WEC_ERROR_T WEC_Deserialize(const uint8_t buffer[], size_t bufferSize,
+        size_t *length) {
+    return WEC_CounterDeserialize(&WEC_defaultCounter, buffer, bufferSize,
+            length);
+}
+
+void WEC_StatsGet(WEC_Stats_T *stats) {
+    WEC_CounterStatsGet(&WEC_defaultCounter, stats);
+}
+
+WEC_ERROR_T WEC_ThresholdAdd(WEC_Threshold_T *threshold, WEC_COUNT_T upper,
+        WEC_COUNT_T lower, WEC_ThresholdCallback_T callback, void *context) {
+    return WEC_CounterThresholdAdd(&WEC_defaultCounter, threshold, upper, lower,
+            callback, context);
+}
+
+void WEC_ThresholdRemove(WEC_Threshold_T *threshold) {
+    WEC_CounterThresholdRemove(&WEC_defaultCounter, threshold);
+}
+
+WEC_ERROR_T WEC_GapStatsEnable(WEC_GapTracker_T *tracker,
+        WEC_GapEntry_T minQueue[], WEC_GapEntry_T maxQueue[], size_t capacity) {
+    return WEC_CounterGapStatsEnable(&WEC_defaultCounter, tracker, minQueue,
+            maxQueue, capacity);
+}
+
+void WEC_GapStatsDisable(void) {
+    WEC_CounterGapStatsDisable(&WEC_defaultCounter);
+}
+
+WEC_ERROR_T WEC_GapStatsGet(WEC_TIME_T currentTime, WEC_GapStats_T *stats) {
+    return WEC_CounterGapStatsGet(&WEC_defaultCounter, currentTime, stats);
 }
 
 WEC_TIME_T WEC_WindowLimitGet(void) {
-    return WEC_windowLimit;
+    return WEC_CounterWindowLimitGet(&WEC_defaultCounter);
 }
 
 WEC_ERROR_T WEC_WindowLimitSet(WEC_TIME_T windowLimit) {
+    return WEC_CounterWindowLimitSet(&WEC_defaultCounter, windowLimit);
+}
+
+WEC_TIME_T WEC_LatenessLimitGet(void) {
+    return WEC_CounterLatenessLimitGet(&WEC_defaultCounter);
+}
+
+WEC_ERROR_T WEC_LatenessLimitSet(WEC_TIME_T latenessLimit) {
+    return WEC_CounterLatenessLimitSet(&WEC_defaultCounter, latenessLimit);
+}
+
+WEC_ERROR_T WEC_WindowStart(WEC_TIME_T startTime) {
+    return WEC_CounterWindowStart(&WEC_defaultCounter, startTime);
+}
+
+WEC_ERROR_T WEC_WindowStop(WEC_TIME_T stopTime) {
+    return WEC_CounterWindowStop(&WEC_defaultCounter, stopTime);
+}
+
+WEC_TIME_T WEC_WindowTimeGet(WEC_TIME_T currentTime) {
+    return WEC_CounterWindowTimeGet(&WEC_defaultCounter, currentTime);
+}
+
+//
+// Section: Windowed Event Counter Instance APIs
+//
+
+WEC_ERROR_T WEC_CounterInit(WEC_Counter_T *counter, WEC_TIME_T eventBuffer[],
+        size_t capacity) {
+    assert(NULL != counter);
+    if ((NULL == eventBuffer) || (false == WEC_CapacityValid(capacity))) {
+        return WEC_ERROR;
+    }
+    counter->eventBuffer = eventBuffer;
+    counter->weightBuffer = NULL;
+    counter->capacity = (WEC_COUNT_T) capacity;
+    counter->capacityLimit = (WEC_COUNT_T) capacity;
+    counter->extensions = NULL;
+    counter->startTime = 0U;
+    counter->stopTime = 0U;
+    counter->windowLimit = 0U;
+    counter->latenessLimit = 0U;
+    counter->started = false;
+#if WEC_STATS_ENABLE
+    memset(&counter->stats, 0, sizeof (counter->stats));
+#endif
+    WEC_CounterEventsClear(counter);
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CounterInitWeighted(WEC_Counter_T *counter,
+        WEC_TIME_T eventBuffer[], WEC_WEIGHT_T weightBuffer[], size_t capacity) {
+    if (NULL == weightBuffer) {
+        return WEC_ERROR;
+    }
+    WEC_ERROR_T err = WEC_CounterInit(counter, eventBuffer, capacity);
+    if (WEC_OKAY == err) {
+        counter->weightBuffer = weightBuffer;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_CounterInitAllocated(WEC_Counter_T *counter,
+        const WEC_Allocator_T *allocator, WEC_CounterExtensions_T *extensions,
+        size_t capacity, size_t capacityLimit) {
+    assert(NULL != counter);
+    if ((NULL == allocator) || (NULL == extensions)
+            || (false == WEC_CapacityValid(capacity))
+            || (false == WEC_CapacityValid(capacityLimit))
+            || (capacityLimit < capacity)) {
+        return WEC_ERROR;
+    }
+    WEC_TIME_T *eventBuffer = allocator->allocate(allocator->context,
+            capacity * sizeof (WEC_TIME_T));
+    if (NULL == eventBuffer) {
+        return WEC_ERROR;
+    }
+    (void) WEC_CounterInit(counter, eventBuffer, capacity);
+    extensions->allocator = allocator;
+    extensions->thresholds = NULL;
+    extensions->gaps = NULL;
+    extensions->clock = NULL;
+    counter->extensions = extensions;
+    counter->capacityLimit = (WEC_COUNT_T) capacityLimit;
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CounterExtensionsSet(WEC_Counter_T *counter,
+        WEC_CounterExtensions_T *extensions) {
+    if (NULL == extensions) {
+        return WEC_ERROR;
+    }
+    if (NULL == counter->extensions) {
+        extensions->allocator = NULL;
+        extensions->thresholds = NULL;
+        extensions->gaps = NULL;
+        extensions->clock = NULL;
+    } else if (extensions != counter->extensions) {
+        *extensions = *counter->extensions;
+    }
+    counter->extensions = extensions;
+    return WEC_OKAY;
+}
+
+void WEC_CounterDeinit(WEC_Counter_T *counter) {
+    assert(NULL != counter);
+    counter->started = false;
+    WEC_CounterEventsClear(counter);
+    const WEC_Allocator_T *allocator = WEC_AllocatorGet(counter);
+    if (NULL != allocator) {
+        allocator->release(allocator->context, counter->eventBuffer,
+                counter->capacity * sizeof (WEC_TIME_T));
+    }
+    counter->eventBuffer = NULL;
+    counter->weightBuffer = NULL;
+    counter->capacity = 0U;
+    counter->extensions = NULL;
+}
+
+WEC_ERROR_T WEC_CounterEventAdd(WEC_Counter_T *counter, WEC_TIME_T eventTime) {
+    return WEC_EventRecord(counter, eventTime, 1U);
+}
+
+WEC_ERROR_T WEC_CounterEventAddWeighted(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight) {
+    if (NULL == counter->weightBuffer) {
+        return WEC_ERROR;
+    }
+    return WEC_EventRecord(counter, eventTime, weight);
+}
+
+WEC_ERROR_T WEC_CounterEventTryAdd(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_COUNT_T limit, WEC_TIME_T *waitTime) {
+    assert(0U < limit);
+    if (NULL != waitTime) {
+        *waitTime = 0U;
+    }
+    WEC_TIME_T lateness = 0U;
+    if ((0U != counter->latenessLimit) && (0U < counter->count)) {
+        lateness = WEC_EventLatenessGet(counter, eventTime);
+    }
+    if (0U != lateness) {
+        // Late events are checked against the window of the newest event
+        if (false == counter->started) {
+            return WEC_NOT_STARTED;
+        }
+        if (counter->latenessLimit < lateness) {
+            return WEC_EVENT_TOO_LATE;
+        }
+    } else if (WEC_NOT_STARTED == WEC_WindowShift(counter, eventTime)) {
+        return WEC_NOT_STARTED;
+    }
+    if (limit <= counter->count) {
+        if (NULL != waitTime) {
+            // Another event fits once this one and all before it expire
+            WEC_COUNT_T index = WEC_IndexAdvance(counter, counter->tail,
+                    counter->count - limit);
+            WEC_TIME_T age = eventTime
+                    - counter->eventBuffer[WEC_SLOT(counter, index)];
+            *waitTime = counter->windowLimit - age;
+        }
+        return WEC_LIMIT_EXCEEDED;
+    }
+    if (0U != lateness) {
+        return WEC_EventLateInsert(counter, eventTime, 1U, lateness);
+    }
+    WEC_ERROR_T overflowResult = WEC_OverflowCheck(counter);
+    WEC_EventEnqueue(counter, eventTime, 1U);
+    WEC_StatsAddRecord(counter, 1U);
+    WEC_ThresholdsCheck(counter);
+    return overflowResult;
+}
+
+WEC_ERROR_T WEC_CounterEventAddBatch(WEC_Counter_T *counter,
+        const WEC_TIME_T eventTimes[], size_t eventCount,
+        size_t *overflowCount) {
+    size_t dropped = 0U;
+    WEC_ERROR_T lateResult = WEC_OKAY;
+
+    if (NULL != overflowCount) {
+        *overflowCount = 0U;
+    }
+    if (false == counter->started) {
+        return WEC_NOT_STARTED;
+    }
+
+    // Events older than the newest stored one are inserted in order one at a
+    // time.  The batch is oldest first, so once one is not late none are.
+    while ((0U < eventCount) && (0U != counter->latenessLimit)
+            && (0U < counter->count)
+            && (0U != WEC_EventLatenessGet(counter, *eventTimes))) {
+        WEC_ERROR_T err = WEC_EventRecord(counter, *eventTimes, 1U);
+        if (WEC_BUFFER_OVERFLOW == err) {
+            dropped++;
+        } else if (WEC_EVENT_TOO_LATE == err) {
+            lateResult = WEC_EVENT_TOO_LATE;
+        }
+        eventTimes++;
+        eventCount--;
+    }
+    if (0U == eventCount) {
+        if (NULL != overflowCount) {
+            *overflowCount = dropped;
+        }
+        return (0U == dropped) ? lateResult : WEC_BUFFER_OVERFLOW;
+    }
+
+    // Expire once against the newest event, which also expires every event in
+    // the batch older than the window.
+    size_t offered = eventCount;
+    WEC_TIME_T newestTime = eventTimes[eventCount - 1U];
+    (void) WEC_WindowShift(counter, newestTime);
+    uint64_t startTicks = WEC_STATS_TICKS_READ();
+    while ((1U < eventCount)
+            && ((WEC_TIME_T) (newestTime - *eventTimes)
+            >= counter->windowLimit)) {
+        eventTimes++;
+        eventCount--;
+    }
+    if (offered != eventCount) {
+        WEC_StatsExpiryRecord(counter, offered - eventCount, startTicks);
+    }
+
+    // Only the newest events that fit in the buffer are kept
+    if ((size_t) (counter->capacity - counter->count) < eventCount) {
+        (void) WEC_BufferGrow(counter, counter->count + eventCount);
+    }
+    if (counter->capacity < eventCount) {
+        dropped = eventCount - counter->capacity;
+        eventTimes += dropped;
+        eventCount = counter->capacity;
+    }
+    WEC_COUNT_T room = counter->capacity - counter->count;
+    if (room < eventCount) {
+        WEC_COUNT_T overflow = (WEC_COUNT_T) eventCount - room;
+        dropped += overflow;
+        WEC_EventsOldestRemove(counter, overflow);
+    }
+    WEC_EventsEnqueue(counter, eventTimes, (WEC_COUNT_T) eventCount);
+    WEC_StatsAddRecord(counter, offered);
+    WEC_StatsOverflowRecord(counter, dropped);
+    WEC_ThresholdsCheck(counter);
+
+    if (NULL != overflowCount) {
+        *overflowCount = dropped;
+    }
+    return (0U == dropped) ? lateResult : WEC_BUFFER_OVERFLOW;
+}
+
+WEC_COUNT_T WEC_CounterEventCountGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime) {
+    (void) WEC_WindowShift(counter, currentTime);
+    return counter->count;
+}
+
+WEC_COUNT_T WEC_CounterEventCountRange(const WEC_Counter_T *counter,
+        WEC_TIME_T startTime, WEC_TIME_T endTime) {
+    WEC_TIME_T length = endTime - startTime;
+    if ((0U == counter->count) || (0U == length) || (WEC_TIME_HALF <= length)) {
+        return 0U;
+    }
+    // Measure ages from the newest event, the one time every stored event is
+    // known not to be later than
+    WEC_COUNT_T newest = WEC_IndexAdvance(counter, counter->tail,
+            counter->count - 1U);
+    WEC_TIME_T newestTime = counter->eventBuffer[WEC_SLOT(counter, newest)];
+    WEC_TIME_T startAge = newestTime - startTime;
+    if ((0U == startAge) || (WEC_TIME_HALF <= startAge)) {
+        return 0U; // Range starts at or after the newest event
+    }
+    WEC_TIME_T endAge = newestTime - endTime;
+    WEC_COUNT_T afterEnd = 0U;
+    if ((0U != endAge) && (endAge < WEC_TIME_HALF)) {
+        afterEnd = WEC_EventsYoungerCount(counter, newestTime, endAge);
+    }
+    return WEC_EventsYoungerCount(counter, newestTime, startAge) - afterEnd;
+}
+
+WEC_ERROR_T WEC_CounterSerialize(const WEC_Counter_T *counter, uint8_t buffer[],
+        size_t bufferSize, size_t *length) {
+    assert(NULL != length);
+    bool weighted = (NULL != counter->weightBuffer);
+    size_t offset = WEC_SERIAL_HEADER_SIZE;
+    bool fits = (WEC_SERIAL_HEADER_SIZE <= bufferSize);
+    *length = 0U;
+    if (fits) {
+        buffer[0] = WEC_SERIAL_VERSION;
+        buffer[1] = (uint8_t) ((counter->started ? WEC_SERIAL_STARTED : 0U)
+                | (weighted ? WEC_SERIAL_WEIGHTED : 0U));
+        buffer[2] = (uint8_t) sizeof (WEC_TIME_T);
+        buffer[3] = (uint8_t) sizeof (WEC_COUNT_T);
+        buffer[4] = (uint8_t) sizeof (WEC_WEIGHT_T);
+    }
+    fits = fits
+            && WEC_VarintWrite(buffer, bufferSize, &offset, counter->windowLimit)
+            && WEC_VarintWrite(buffer, bufferSize, &offset, counter->startTime)
+            && WEC_VarintWrite(buffer, bufferSize, &offset, counter->stopTime)
+            && WEC_VarintWrite(buffer, bufferSize, &offset, counter->count);
+
+    // Times are stored oldest first, so each one is a small step forward from
+    // the one before, even across time overflow
+    WEC_COUNT_T index = counter->tail;
+    WEC_TIME_T previousTime = 0U;
+    WEC_WEIGHT_T previousWeight = counter->removedWeight;
+    for (WEC_COUNT_T i = 0U; fits && (i < counter->count); i++) {
+        WEC_COUNT_T slot = WEC_SLOT(counter, index);
+        WEC_TIME_T time = counter->eventBuffer[slot];
+        fits = WEC_VarintWrite(buffer, bufferSize, &offset,
+                (WEC_TIME_T) (time - previousTime));
+        previousTime = time;
+        if (weighted) {
+            WEC_WEIGHT_T weight = counter->weightBuffer[slot];
+            fits = fits && WEC_VarintWrite(buffer, bufferSize, &offset,
+                    (WEC_WEIGHT_T) (weight - previousWeight));
+            previousWeight = weight;
+        }
+        index = WEC_IndexIncrement(counter, index);
+    }
+
+    if (false == fits) {
+        return WEC_ERROR;
+    }
+    *length = offset;
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CounterDeserialize(WEC_Counter_T *counter,
+        const uint8_t buffer[], size_t bufferSize, size_t *length) {
+    assert(NULL != length);
+    uint64_t windowLimit;
+    uint64_t startTime;
+    uint64_t stopTime;
+    uint64_t eventCount;
+    size_t offset = WEC_SERIAL_HEADER_SIZE;
+
+    *length = 0U;
+    counter->started = false;
+    WEC_CounterEventsClear(counter);
+    if ((WEC_SERIAL_HEADER_SIZE > bufferSize)
+            || (WEC_SERIAL_VERSION != buffer[0])
+            || (0U != (buffer[1]
+            & (uint8_t) ~(WEC_SERIAL_STARTED | WEC_SERIAL_WEIGHTED)))
+            || (sizeof (WEC_TIME_T) != buffer[2])
+            || (sizeof (WEC_COUNT_T) != buffer[3])
+            || (sizeof (WEC_WEIGHT_T) != buffer[4])) {
+        return WEC_ERROR;
+    }
+    bool weighted = (0U != (buffer[1] & WEC_SERIAL_WEIGHTED));
+    if (!WEC_VarintRead(buffer, bufferSize, &offset, &windowLimit)
+            || !WEC_VarintRead(buffer, bufferSize, &offset, &startTime)
+            || !WEC_VarintRead(buffer, bufferSize, &offset, &stopTime)
+            || !WEC_VarintRead(buffer, bufferSize, &offset, &eventCount)) {
+        return WEC_ERROR;
+    }
+
+    // Keep only the newest events that fit
+    if (counter->capacity < eventCount) {
+        (void) WEC_BufferGrow(counter, (size_t) eventCount);
+    }
+    uint64_t dropped = 0U;
+    if (counter->capacity < eventCount) {
+        dropped = eventCount - counter->capacity;
+    }
+
+    WEC_TIME_T time = 0U;
+    for (uint64_t i = 0U; i < eventCount; i++) {
+        uint64_t timeStep;
+        uint64_t weight = 1U;
+        if (!WEC_VarintRead(buffer, bufferSize, &offset, &timeStep)
+                || (weighted
+                && !WEC_VarintRead(buffer, bufferSize, &offset, &weight))) {
+            WEC_CounterEventsClear(counter);
+            return WEC_ERROR;
+        }
+        time += (WEC_TIME_T) timeStep;
+        if (i >= dropped) {
+            WEC_EventEnqueue(counter, time, (WEC_WEIGHT_T) weight);
+        }
+    }
+
+    counter->windowLimit = (WEC_TIME_T) windowLimit;
+    counter->startTime = (WEC_TIME_T) startTime;
+    counter->stopTime = (WEC_TIME_T) stopTime;
+    counter->started = (0U != (buffer[1] & WEC_SERIAL_STARTED));
+    *length = offset;
+    WEC_ThresholdsCheck(counter);
+    return (0U == dropped) ? WEC_OKAY : WEC_BUFFER_OVERFLOW;
+}
+
+void WEC_CounterStatsGet(const WEC_Counter_T *counter, WEC_Stats_T *stats) {
+    assert(NULL != stats);
+#if WEC_STATS_ENABLE
+    *stats = counter->stats;
+#else
+    (void) counter;
+    memset(stats, 0, sizeof (*stats));
+#endif
+}
+
+WEC_ERROR_T WEC_CounterThresholdAdd(WEC_Counter_T *counter,
+        WEC_Threshold_T *threshold, WEC_COUNT_T upper, WEC_COUNT_T lower,
+        WEC_ThresholdCallback_T callback, void *context) {
+    assert(NULL != threshold);
+    if ((NULL == counter->extensions) || (NULL == callback)
+            || (upper <= lower)) {
+        return WEC_ERROR;
+    }
+    threshold->callback = callback;
+    threshold->context = context;
+    threshold->upper = upper;
+    threshold->lower = lower;
+    threshold->above = (upper <= counter->count);
+    threshold->next = counter->extensions->thresholds;
+    counter->extensions->thresholds = threshold;
+    return WEC_OKAY;
+}
+
+WEC_ERROR_T WEC_CounterGapStatsEnable(WEC_Counter_T *counter,
+        WEC_GapTracker_T *tracker, WEC_GapEntry_T minQueue[],
+        WEC_GapEntry_T maxQueue[], size_t capacity) {
+    if ((NULL == counter->extensions) || (NULL == tracker)
+            || (NULL == minQueue) || (NULL == maxQueue)
+            || (false == WEC_CapacityValid(capacity))
+            || (capacity < counter->capacityLimit)) {
+        return WEC_ERROR;
+    }
+    tracker->minQueue.entries = minQueue;
+    tracker->maxQueue.entries = maxQueue;
+    tracker->capacity = (WEC_COUNT_T) capacity;
+    counter->extensions->gaps = tracker;
+    WEC_GapsRebuild(counter);
+    return WEC_OKAY;
+}
+
+void WEC_CounterGapStatsDisable(WEC_Counter_T *counter) {
+    if (NULL != counter->extensions) {
+        counter->extensions->gaps = NULL;
+    }
+}
+
+WEC_ERROR_T WEC_CounterGapStatsGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime, WEC_GapStats_T *stats) {
+    assert(NULL != stats);
+    const WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    if (NULL == gaps) {
+        return WEC_ERROR;
+    }
+    (void) WEC_WindowShift(counter, currentTime);
+    memset(stats, 0, sizeof (*stats));
+    if (counter->count < 2U) {
+        return WEC_OKAY;
+    }
+    stats->gapCount = counter->count - 1U;
+    stats->gapMin = gaps->minQueue.entries[gaps->minQueue.head].gap;
+    stats->gapMax = gaps->maxQueue.entries[gaps->maxQueue.head].gap;
+    // The gaps add up to the time from the oldest event to the newest
+    WEC_COUNT_T newest = WEC_IndexAdvance(counter, counter->tail,
+            counter->count - 1U);
+    WEC_TIME_T span = counter->eventBuffer[WEC_SLOT(counter, newest)]
+            - counter->eventBuffer[WEC_SLOT(counter, counter->tail)];
+    double mean = (double) span / stats->gapCount;
+    double variance = ((double) gaps->squareSum / stats->gapCount)
+            - (mean * mean);
+    stats->gapMean = mean;
+    stats->gapVariance = (0.0 < variance) ? variance : 0.0;
+    return WEC_OKAY;
+}
+
+void WEC_CounterThresholdRemove(WEC_Counter_T *counter,
+        WEC_Threshold_T *threshold) {
+    if (NULL == counter->extensions) {
+        return;
+    }
+    WEC_Threshold_T **link = &counter->extensions->thresholds;
+    while (NULL != *link) {
+        if (threshold == *link) {
+            *link = threshold->next;
+            threshold->next = NULL;
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
+WEC_WEIGHT_T WEC_CounterEventSumGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime) {
+    (void) WEC_WindowShift(counter, currentTime);
+    if (NULL == counter->weightBuffer) {
+        return counter->count;
+    }
+    return counter->addedWeight - counter->removedWeight;
+}
+
+WEC_ERROR_T WEC_CounterOldestTimeGet(const WEC_Counter_T *counter,
+        WEC_TIME_T *oldestTime) {
+    assert(NULL != oldestTime);
+    if (0U == counter->count) {
+        return WEC_ERROR;
+    }
+    *oldestTime = counter->eventBuffer[WEC_SLOT(counter, counter->tail)];
+    return WEC_OKAY;
+}
+
+void WEC_CounterEventsClear(WEC_Counter_T *counter) {
+    counter->count = 0;
+    counter->head = 0;
+    counter->tail = 0;
+    counter->addedWeight = 0U;
+    counter->removedWeight = 0U;
+    WEC_GapTracker_T *gaps = WEC_GapsGet(counter);
+    if (NULL != gaps) {
+        WEC_GapsClear(gaps);
+    }
+    WEC_ThresholdsCheck(counter);
+}
+
+WEC_TIME_T WEC_CounterWindowLimitGet(const WEC_Counter_T *counter) {
+    return counter->windowLimit;
+}
+
+WEC_ERROR_T WEC_CounterWindowLimitSet(WEC_Counter_T *counter,
+        WEC_TIME_T windowLimit) {
 
     WEC_ERROR_T err = WEC_ERROR;
 
-    if (false == WEC_started) {
+    if (false == counter->started) {
         err = WEC_OKAY;
-        WEC_windowLimit = windowLimit;
+        counter->windowLimit = windowLimit;
     } else {
         err = WEC_ALREADY_STARTED;
     }
@@ -226,38 +1419,56 @@ WEC_ERROR_T WEC_WindowLimitSet(WEC_TIME_T windowLimit) {
     return err;
 }
 
-WEC_ERROR_T WEC_WindowStart(WEC_TIME_T startTime) {
+WEC_TIME_T WEC_CounterLatenessLimitGet(const WEC_Counter_T *counter) {
+    return counter->latenessLimit;
+}
+
+WEC_ERROR_T WEC_CounterLatenessLimitSet(WEC_Counter_T *counter,
+        WEC_TIME_T latenessLimit) {
     WEC_ERROR_T err = WEC_ERROR;
-    if (false == WEC_started) {
+    if (false == counter->started) {
         err = WEC_OKAY;
-        WEC_started = true;
-        WEC_startTime = startTime;
+        counter->latenessLimit = latenessLimit;
     } else {
         err = WEC_ALREADY_STARTED;
     }
     return err;
 }
 
-WEC_ERROR_T WEC_WindowStop(WEC_TIME_T stopTime) {
+WEC_ERROR_T WEC_CounterWindowStart(WEC_Counter_T *counter,
+        WEC_TIME_T startTime) {
     WEC_ERROR_T err = WEC_ERROR;
-    if (true == WEC_started) {
+    if (false == counter->started) {
         err = WEC_OKAY;
-        WEC_WindowShift(stopTime);
-        WEC_started = false;
-        WEC_stopTime = stopTime;
+        counter->started = true;
+        counter->startTime = startTime;
+    } else {
+        err = WEC_ALREADY_STARTED;
+    }
+    return err;
+}
+
+WEC_ERROR_T WEC_CounterWindowStop(WEC_Counter_T *counter, WEC_TIME_T stopTime) {
+    WEC_ERROR_T err = WEC_ERROR;
+    if (true == counter->started) {
+        err = WEC_OKAY;
+        WEC_WindowShift(counter, stopTime);
+        counter->started = false;
+        counter->stopTime = stopTime;
     } else {
         err = WEC_NOT_STARTED;
     }
     return err;
 }
 
-WEC_TIME_T WEC_WindowTimeGet(WEC_TIME_T currentTime) {
+WEC_TIME_T WEC_CounterWindowTimeGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime) {
     WEC_TIME_T windowTime;
-    if (WEC_started) {
-        WEC_startTime = WEC_StartTimeUpdate(currentTime);
-        windowTime = currentTime - WEC_startTime;
+    if (counter->started) {
+        counter->startTime = WEC_StartTimeUpdate(counter, currentTime);
+        windowTime = currentTime - counter->startTime;
     } else {
-        windowTime = WEC_stopTime - WEC_startTime;
+        windowTime = counter->stopTime - counter->startTime;
     }
     return windowTime;
 }
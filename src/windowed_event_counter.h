@@ -50,14 +50,75 @@
 //
 
 #    include <stdbool.h>
+#    include <stddef.h>
 #    include <stdint.h>
 
+#    ifdef __cplusplus
+extern "C" {
+#    endif
+
 //
 // Section: Constants
 //
 
-/// Number of available elements in the event buffer.
-#    define WEC_EVENT_BUFFER_SIZE (30U)
+/// Number of available elements in the event buffer of the default counter.
+/// A power of two lets buffers be indexed with a mask instead of checking for
+/// wrap around on every access, but then every counter capacity must also be a
+/// power of two.
+#    ifndef WEC_EVENT_BUFFER_SIZE
+#        define WEC_EVENT_BUFFER_SIZE (30U)
+#    endif
+
+/// Unsigned type used to store event times.
+#    ifndef WEC_TIME_TYPE
+#        define WEC_TIME_TYPE uint32_t
+#    endif
+
+/// Unsigned type used to count events.
+/// Must be able to hold WEC_EVENT_BUFFER_SIZE.
+#    ifndef WEC_COUNT_TYPE
+#        define WEC_COUNT_TYPE uint8_t
+#    endif
+
+/// Unsigned type used to sum event weights.
+/// Sums wrap around like times, so a window sum is exact as long as it fits.
+#    ifndef WEC_WEIGHT_TYPE
+#        define WEC_WEIGHT_TYPE uint32_t
+#    endif
+
+/// Set to 1 to keep runtime statistics in every counter
+#    ifndef WEC_STATS_ENABLE
+#        define WEC_STATS_ENABLE (0)
+#    endif
+
+/// Reads a free running tick counter used to time expiry for the runtime
+/// statistics.  Defaults to the time stamp counter on x86 and to no timing
+/// elsewhere.
+#    ifndef WEC_STATS_TICKS
+#        if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#            define WEC_STATS_TICKS() ((uint64_t) __builtin_ia32_rdtsc())
+#        else
+#            define WEC_STATS_TICKS() ((uint64_t) 0U)
+#        endif
+#    endif
+
+/// Version of the format written by WEC_CounterSerialize()
+#    define WEC_SERIAL_VERSION (2U)
+
+/// Most bytes a variable length encoded value of a type takes
+#    define WEC_VARINT_SIZE_MAX(type) (((sizeof (type) * 8U) + 6U) / 7U)
+
+/// Most bytes WEC_CounterSerialize() writes for a counter holding eventCount
+/// events
+#    define WEC_SERIAL_SIZE_MAX(eventCount) \
+        (5U + (3U * WEC_VARINT_SIZE_MAX(WEC_TIME_T)) \
+        + WEC_VARINT_SIZE_MAX(WEC_COUNT_T) \
+        + ((eventCount) * (WEC_VARINT_SIZE_MAX(WEC_TIME_T) \
+        + WEC_VARINT_SIZE_MAX(WEC_WEIGHT_T))))
+
+/// Evaluates true when the event buffer is indexed with a mask
+#    define WEC_EVENT_BUFFER_MASKED \
+        ((WEC_EVENT_BUFFER_SIZE & (WEC_EVENT_BUFFER_SIZE - 1U)) == 0U)
 
 //
 // Section: Data Types
@@ -79,14 +140,214 @@ typedef enum {
     /// this error.
     WEC_NOT_STARTED,
     /// Added event to a full buffer.
-    /// Try increasing WEC_EVENT_BUFFER_SIZE.
+    /// Try increasing WEC_EVENT_BUFFER_SIZE or the counter's capacity.
     /// @see WEC_EVENT_BUFFER_SIZE
     WEC_BUFFER_OVERFLOW,
+    /// Added a new key to a table with no room for it.
+    /// Expire idle keys or give the table more entries.
+    WEC_TABLE_FULL,
+    /// Event was not added because the window already holds the limit.
+    /// Retry once the wait time reported with this error has passed.
+    WEC_LIMIT_EXCEEDED,
+    /// Event is older than the newest event by more than the lateness limit
+    /// and was not added.
+    /// @see WEC_LatenessLimitSet
+    WEC_EVENT_TOO_LATE,
 } WEC_ERROR_T;
 
-typedef uint32_t WEC_TIME_T;
+typedef WEC_TIME_TYPE WEC_TIME_T;
+
+typedef WEC_COUNT_TYPE WEC_COUNT_T;
+
+typedef WEC_WEIGHT_TYPE WEC_WEIGHT_T;
+
+/**
+ * Memory source for event buffers.
+ * Lets counters take their event storage from an arena or pool instead of
+ * static arrays.
+ */
+typedef struct {
+    /// Returns size bytes of memory aligned for WEC_TIME_T, or NULL when out of
+    /// memory
+    void *(*allocate)(void *context, size_t size);
+    /// Returns memory of the given size obtained from allocate
+    void (*release)(void *context, void *memory, size_t size);
+    /// Passed to allocate and release
+    void *context;
+} WEC_Allocator_T;
+
+/**
+ * Runtime statistics of a counter, kept since it was initialized.
+ * All members stay 0 when WEC_STATS_ENABLE is 0.
+ */
+typedef struct {
+    /// Number of events added, including those later dropped
+    uint64_t adds;
+    /// Number of events dropped from a full buffer
+    uint64_t overflows;
+    /// Number of events removed because they left the window
+    uint64_t expirations;
+    /// Ticks of WEC_STATS_TICKS() spent removing expired events
+    uint64_t expiryTicks;
+    /// Most events removed by a single expiry, which a batch add can make
+    /// larger than any count the buffer holds
+    size_t expiryBatchMax;
+    /// Most events held at once
+    WEC_COUNT_T countPeak;
+} WEC_Stats_T;
+
+typedef struct WEC_Threshold_S WEC_Threshold_T;
+
+/**
+ * Called when the count of a counter crosses a threshold.
+ * Runs inside the counter call that changed the count.  The callback must not
+ * call into the same counter, except to remove the threshold passed in.
+ * @param threshold threshold crossed
+ * @param above true when the count rose to the upper level, false when it fell
+ * to the lower level
+ * @param count count of events after the change
+ * @param context pointer passed when the threshold was added
+ */
+typedef void (*WEC_ThresholdCallback_T)(WEC_Threshold_T *threshold,
+        bool above, WEC_COUNT_T count, void *context);
+
+/**
+ * Alarm level on the count of events of a counter.
+ * Raised when the count rises to the upper level and cleared once it falls back
+ * to the lower level, so a count hovering around one level does not raise and
+ * clear on every event.  Treat the members as private.
+ */
+struct WEC_Threshold_S {
+    /// Called on each crossing
+    WEC_ThresholdCallback_T callback;
+    /// Passed to callback
+    void *context;
+    /// Next threshold of the same counter
+    WEC_Threshold_T *next;
+    /// Count at which the alarm is raised
+    WEC_COUNT_T upper;
+    /// Count at which the alarm is cleared
+    WEC_COUNT_T lower;
+    /// Indicates when the alarm is raised
+    bool above;
+};
+
+/// Gap between an event and the one before it, held in the queues that track
+/// the smallest and largest gaps
+typedef struct {
+    /// Time between the two events
+    WEC_TIME_T gap;
+    /// Sequence number of the later event
+    WEC_COUNT_T sequence;
+} WEC_GapEntry_T;
+
+/// Ring of gaps ordered oldest first, with gaps that can no longer be the
+/// smallest (or largest) while in the window left out
+typedef struct {
+    /// Caller storage for the entries
+    WEC_GapEntry_T *entries;
+    /// index of the oldest entry
+    WEC_COUNT_T head;
+    /// Number of entries held
+    WEC_COUNT_T count;
+} WEC_GapQueue_T;
+
+/**
+ * Inter-arrival statistics of a counter, updated as events are added and
+ * removed so queries take constant time.  Treat the members as private.
+ */
+typedef struct {
+    /// Candidates for the smallest gap, increasing from oldest to newest
+    WEC_GapQueue_T minQueue;
+    /// Candidates for the largest gap, decreasing from oldest to newest
+    WEC_GapQueue_T maxQueue;
+    /// Number of entries each queue holds
+    WEC_COUNT_T capacity;
+    /// Sequence number given to the next event added
+    WEC_COUNT_T sequence;
+    /// Sum of the squares of the gaps in the window, exact while it fits
+    uint64_t squareSum;
+} WEC_GapTracker_T;
+
+/// Inter-arrival statistics of the events in the window
+typedef struct {
+    /// Number of gaps between consecutive events, one less than the count
+    WEC_COUNT_T gapCount;
+    /// Smallest gap, 0 when there are no gaps
+    WEC_TIME_T gapMin;
+    /// Largest gap, 0 when there are no gaps
+    WEC_TIME_T gapMax;
+    /// Average gap
+    double gapMean;
+    /// Population variance of the gaps
+    double gapVariance;
+} WEC_GapStats_T;
+
+/// Source of the current time for the ...Now() APIs, defined in wec_clock.h
+typedef struct WEC_Clock_S WEC_Clock_T;
+
+/**
+ * Optional features of a counter.
+ * Kept apart from WEC_Counter_T so counters using none of them stay small.
+ * Attach with WEC_CounterExtensionsSet().  Treat the members as private.
+ */
+typedef struct {
+    /// Source of eventBuffer when it may grow, NULL for caller storage
+    const WEC_Allocator_T *allocator;
+    /// Alarm levels checked whenever the count changes, NULL when none
+    WEC_Threshold_T *thresholds;
+    /// Inter-arrival statistics, NULL when not tracked
+    WEC_GapTracker_T *gaps;
+    /// Source of the current time for the ...Now() APIs, NULL when none
+    WEC_Clock_T *clock;
+} WEC_CounterExtensions_T;
 
-typedef uint8_t WEC_COUNT_T;
+/**
+ * Windowed event counter instance.
+ * Holds all of the state for one measurement window, so any number of
+ * independent counters can live side by side in arrays or pools.  Treat the
+ * members as private and operate on them through the WEC_Counter* APIs.
+ */
+typedef struct {
+    /// Stores the time of each event
+    WEC_TIME_T *eventBuffer;
+    /// Running total of weights up to and including each event, NULL when
+    /// weights are not tracked
+    WEC_WEIGHT_T *weightBuffer;
+    /// Optional features, NULL when none are attached
+    WEC_CounterExtensions_T *extensions;
+    /// Running total of the weights of every event added
+    WEC_WEIGHT_T addedWeight;
+    /// Running total of the weights of every event removed
+    WEC_WEIGHT_T removedWeight;
+    /// Timestamp marking the start of the measurement window
+    WEC_TIME_T startTime;
+    /// Timestamp marking the end of the measurement window
+    WEC_TIME_T stopTime;
+    /// Limit to the length of the time window
+    WEC_TIME_T windowLimit;
+    /// Most an event may be older than the newest event and still be inserted
+    /// in order, 0 when events are appended as they arrive
+    WEC_TIME_T latenessLimit;
+    /// current count of events
+    WEC_COUNT_T count;
+    /// Number of elements in eventBuffer
+    WEC_COUNT_T capacity;
+    /// Largest number of elements eventBuffer may grow to
+    WEC_COUNT_T capacityLimit;
+    /// index of the position to add the next event.
+    /// Runs freely and is masked on access when WEC_EVENT_BUFFER_MASKED.
+    WEC_COUNT_T head;
+    /// index of the oldest event.
+    /// Runs freely and is masked on access when WEC_EVENT_BUFFER_MASKED.
+    WEC_COUNT_T tail;
+    /// Indicates when window is started and running
+    bool started;
+#    if WEC_STATS_ENABLE
+    /// Runtime statistics
+    WEC_Stats_T stats;
+#    endif
+} WEC_Counter_T;
 
 //
 // Section: Template Module APIs
@@ -100,6 +361,55 @@ typedef uint8_t WEC_COUNT_T;
  */
 WEC_ERROR_T WEC_EventAdd(WEC_TIME_T eventTime);
 
+/**
+ * Adds an event only when the window holds fewer than limit events.
+ * Expires once and checks and adds in one step, replacing a call to
+ * WEC_EventCountGet() followed by WEC_EventAdd() in rate limiters.  Late
+ * events are checked against the window of the newest event and inserted in
+ * order, as by WEC_EventAdd().
+ * @param eventTime time at which the event was detected
+ * @param limit number of events the window may hold, at least 1
+ * @param waitTime if not NULL, receives the time from eventTime until enough
+ * events expire to admit another one, or 0 when the event was added
+ * @returns WEC_OKAY when the event was added.
+ * @returns WEC_LIMIT_EXCEEDED when the event was rejected.
+ * @returns WEC_NOT_STARTED when the window is not started.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ * @returns WEC_EVENT_TOO_LATE when the event is older than the lateness limit
+ * allows.
+ */
+WEC_ERROR_T WEC_EventTryAdd(WEC_TIME_T eventTime, WEC_COUNT_T limit,
+        WEC_TIME_T *waitTime);
+
+/**
+ * Updates event count with a batch of events.
+ * Equivalent to calling WEC_EventAdd() for each time in order, but expires and
+ * handles overflow once for the whole batch.  Leading events older than the
+ * newest stored event are inserted in order one at a time.
+ * @param eventTimes times at which the events were detected, oldest first
+ * @param eventCount number of times in eventTimes
+ * @param overflowCount if not NULL, receives the number of events that did not
+ * fit in the buffer and were dropped
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_NOT_STARTED when the window is not started, nothing is added.
+ * @returns WEC_BUFFER_OVERFLOW when events were dropped from a full buffer.
+ * @returns WEC_EVENT_TOO_LATE when no events were dropped but some were older
+ * than the lateness limit allows and skipped.
+ */
+WEC_ERROR_T WEC_EventAddBatch(const WEC_TIME_T eventTimes[], size_t eventCount,
+        size_t *overflowCount);
+
+/**
+ * Updates event count with a new event carrying a weight, such as a number of
+ * bytes or of packets arriving together.
+ * The event takes a single slot in the buffer whatever its weight.
+ * @param eventTime time at which the event was detected
+ * @param weight value summed by WEC_EventSumGet()
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ */
+WEC_ERROR_T WEC_EventAddWeighted(WEC_TIME_T eventTime, WEC_WEIGHT_T weight);
+
 /**
  * Gets the current number of events.
  * Removes expired events and returns the count of remaining events.
@@ -108,11 +418,122 @@ WEC_ERROR_T WEC_EventAdd(WEC_TIME_T eventTime);
  */
 WEC_COUNT_T WEC_EventCountGet(WEC_TIME_T currentTime);
 
+/**
+ * Gets the number of stored events later than startTime and no later than
+ * endTime, such as the last 100 ms of a longer window.
+ * Binary searches the stored events without expiring any, so ranges reaching
+ * back further than the window limit from the newest event miss events that
+ * already expired.
+ * @param startTime exclusive start of the range
+ * @param endTime inclusive end of the range
+ * @returns Count of events in the range, 0 when endTime is not after startTime
+ */
+WEC_COUNT_T WEC_EventCountRange(WEC_TIME_T startTime, WEC_TIME_T endTime);
+
+/**
+ * Gets the sum of the weights of the current events.
+ * Removes expired events and returns the sum of remaining event weights.
+ * Events added by WEC_EventAdd() weigh 1.
+ * @param currentTime
+ * @returns Sum of event weights
+ */
+WEC_WEIGHT_T WEC_EventSumGet(WEC_TIME_T currentTime);
+
+/**
+ * Gets the time of the oldest stored event without expiring any events.
+ * The oldest event expires once the window limit has passed since it.
+ * @param oldestTime receives the time of the oldest event
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when no events are stored.
+ */
+WEC_ERROR_T WEC_OldestTimeGet(WEC_TIME_T *oldestTime);
+
 /**
  * Clears out all events.
  */
 void WEC_EventsClear(void);
 
+/**
+ * Writes the state of the default counter to a buffer.
+ * @param buffer receives the state
+ * @param bufferSize number of bytes available in buffer
+ * @param length receives the number of bytes written
+ * @returns error code
+ * @see WEC_CounterSerialize
+ */
+WEC_ERROR_T WEC_Serialize(uint8_t buffer[], size_t bufferSize, size_t *length);
+
+/**
+ * Restores the state of the default counter from a buffer.
+ * @param buffer state written by WEC_Serialize()
+ * @param bufferSize number of bytes available in buffer
+ * @param length receives the number of bytes read
+ * @returns error code
+ * @see WEC_CounterDeserialize
+ */
+WEC_ERROR_T WEC_Deserialize(const uint8_t buffer[], size_t bufferSize,
+        size_t *length);
+
+/**
+ * Gets a snapshot of the runtime statistics.
+ * @param stats receives the statistics
+ */
+void WEC_StatsGet(WEC_Stats_T *stats);
+
+/**
+ * Adds an alarm level to the count of events.
+ * The callback runs whenever adding or expiring events raises or clears the
+ * alarm.  The alarm starts raised when the count is already at the upper
+ * level.  Counting without thresholds costs a single check.
+ * @param threshold storage for the threshold, not already added, must stay
+ * valid until removed
+ * @param upper count at which the alarm is raised
+ * @param lower count at which the alarm is cleared, below upper
+ * @param callback called on each crossing
+ * @param context passed to callback
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the levels or callback cannot be used.
+ */
+WEC_ERROR_T WEC_ThresholdAdd(WEC_Threshold_T *threshold, WEC_COUNT_T upper,
+        WEC_COUNT_T lower, WEC_ThresholdCallback_T callback, void *context);
+
+/**
+ * Removes an alarm level added by WEC_ThresholdAdd().
+ * @param threshold threshold to remove, ignored when not added
+ */
+void WEC_ThresholdRemove(WEC_Threshold_T *threshold);
+
+/**
+ * Starts tracking the gaps between consecutive events in the window.
+ * Keeps the smallest and largest gaps in queues of candidates and the sum of
+ * squared gaps as events come and go, costing amortized constant time per
+ * event.  Late events rebuild the statistics from every stored event.
+ * @param tracker storage for the statistics, must stay valid until disabled
+ * @param minQueue storage for capacity entries
+ * @param maxQueue storage for capacity entries
+ * @param capacity number of entries in each queue, at least the number of
+ * events the counter can grow to hold
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage cannot be used.
+ */
+WEC_ERROR_T WEC_GapStatsEnable(WEC_GapTracker_T *tracker,
+        WEC_GapEntry_T minQueue[], WEC_GapEntry_T maxQueue[], size_t capacity);
+
+/**
+ * Stops tracking the gaps between events.
+ */
+void WEC_GapStatsDisable(void);
+
+/**
+ * Gets the inter-arrival statistics of the events in the window.
+ * Removes expired events first.
+ * @param currentTime
+ * @param stats receives the statistics
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when gaps are not tracked.
+ */
+WEC_ERROR_T WEC_GapStatsGet(WEC_TIME_T currentTime, WEC_GapStats_T *stats);
+
 /**
  * Gets the value of the current window limit.
  * @returns the current window limit
@@ -126,6 +547,22 @@ WEC_TIME_T WEC_WindowLimitGet(void);
  */
 WEC_ERROR_T WEC_WindowLimitSet(WEC_TIME_T windowLimit);
 
+/**
+ * Gets the value of the current lateness limit.
+ * @returns the current lateness limit
+ */
+WEC_TIME_T WEC_LatenessLimitGet(void);
+
+/**
+ * Sets how much older than the newest event an event may be.
+ * Events arriving out of order by up to latenessLimit are inserted in order,
+ * later ones are rejected with WEC_EVENT_TOO_LATE.  With the default of 0,
+ * events are appended as they arrive and must be added in order.
+ * @param latenessLimit most an event may be older than the newest event
+ * @return error
+ */
+WEC_ERROR_T WEC_LatenessLimitSet(WEC_TIME_T latenessLimit);
+
 /**
  * Starts measurement
  * @param startTime
@@ -147,6 +584,344 @@ WEC_ERROR_T WEC_WindowStop(WEC_TIME_T stopTime);
  */
 WEC_TIME_T WEC_WindowTimeGet(WEC_TIME_T currentTime);
 
+//
+// Section: Windowed Event Counter Instance APIs
+//
+
+/**
+ * Initializes a counter instance storing events in caller supplied memory.
+ * The counter starts out stopped, empty, without extensions and with a window
+ * limit of 0.
+ * @param counter instance to initialize
+ * @param eventBuffer storage for event times, must outlive the counter
+ * @param capacity number of elements in eventBuffer.  Must be a power of two
+ * when WEC_EVENT_BUFFER_MASKED.
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when eventBuffer or capacity cannot be used.
+ */
+WEC_ERROR_T WEC_CounterInit(WEC_Counter_T *counter, WEC_TIME_T eventBuffer[],
+        size_t capacity);
+
+/**
+ * Initializes a counter instance that also sums event weights.
+ * Otherwise the same as WEC_CounterInit().
+ * @param counter instance to initialize
+ * @param eventBuffer storage for event times, must outlive the counter
+ * @param weightBuffer storage for event weights with as many elements as
+ * eventBuffer, must outlive the counter
+ * @param capacity number of elements in eventBuffer and weightBuffer
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the buffers or capacity cannot be used.
+ */
+WEC_ERROR_T WEC_CounterInitWeighted(WEC_Counter_T *counter,
+        WEC_TIME_T eventBuffer[], WEC_WEIGHT_T weightBuffer[], size_t capacity);
+
+/**
+ * Initializes a counter instance storing events in memory from an allocator.
+ * Instead of dropping the oldest event when the buffer is full, the buffer is
+ * doubled until it reaches capacityLimit.  Events are only dropped once the
+ * buffer can no longer grow or the allocator runs out of memory.
+ * @param counter instance to initialize
+ * @param allocator source of event storage, must outlive the counter
+ * @param extensions storage for the optional features, where the allocator is
+ * kept, must outlive the counter
+ * @param capacity initial number of events the buffer holds
+ * @param capacityLimit largest number of events the buffer may grow to
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the capacities cannot be used or the allocator is out
+ * of memory.
+ */
+WEC_ERROR_T WEC_CounterInitAllocated(WEC_Counter_T *counter,
+        const WEC_Allocator_T *allocator, WEC_CounterExtensions_T *extensions,
+        size_t capacity, size_t capacityLimit);
+
+/**
+ * Attaches storage for the optional features of a counter.
+ * Thresholds, gap statistics and clocks can only be added once a counter has
+ * extensions.  Features already attached carry over to the new storage.
+ * @param counter instance to update
+ * @param extensions storage for the optional features, must outlive the
+ * counter
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when extensions is NULL.
+ */
+WEC_ERROR_T WEC_CounterExtensionsSet(WEC_Counter_T *counter,
+        WEC_CounterExtensions_T *extensions);
+
+/**
+ * Releases a counter instance.
+ * Stops the window, clears out all events and returns allocated storage to its
+ * allocator.  The instance must be initialized again before reuse.
+ * @param counter instance to release
+ */
+void WEC_CounterDeinit(WEC_Counter_T *counter);
+
+/**
+ * Updates event count of a counter with a new event.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ * @returns WEC_EVENT_TOO_LATE when the event is older than the lateness limit
+ * allows.
+ * @see WEC_EventAdd
+ */
+WEC_ERROR_T WEC_CounterEventAdd(WEC_Counter_T *counter, WEC_TIME_T eventTime);
+
+/**
+ * Adds an event to a counter only when its window holds fewer than limit
+ * events.
+ * @param counter instance to update
+ * @param eventTime time at which the event was detected
+ * @param limit number of events the window may hold, at least 1
+ * @param waitTime if not NULL, receives the time from eventTime until enough
+ * events expire to admit another one, or 0 when the event was added
+ * @returns error code
+ * @see WEC_EventTryAdd
+ */
+WEC_ERROR_T WEC_CounterEventTryAdd(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_COUNT_T limit, WEC_TIME_T *waitTime);
+
+/**
+ * Updates event count of a counter with a batch of events.
+ * @param counter instance to update
+ * @param eventTimes times at which the events were detected, oldest first
+ * @param eventCount number of times in eventTimes
+ * @param overflowCount if not NULL, receives the number of events that did not
+ * fit in the buffer and were dropped
+ * @returns error code
+ * @see WEC_EventAddBatch
+ */
+WEC_ERROR_T WEC_CounterEventAddBatch(WEC_Counter_T *counter,
+        const WEC_TIME_T eventTimes[], size_t eventCount,
+        size_t *overflowCount);
+
+/**
+ * Updates event count of a counter with a new weighted event.
+ * @param counter instance to update, initialized by WEC_CounterInitWeighted()
+ * @param eventTime time at which the event was detected
+ * @param weight value summed by WEC_CounterEventSumGet()
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+ * @returns WEC_ERROR when the counter does not track weights, nothing is
+ * added.
+ * @see WEC_EventAddWeighted
+ */
+WEC_ERROR_T WEC_CounterEventAddWeighted(WEC_Counter_T *counter,
+        WEC_TIME_T eventTime, WEC_WEIGHT_T weight);
+
+/**
+ * Gets the current number of events of a counter.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Count of events
+ * @see WEC_EventCountGet
+ */
+WEC_COUNT_T WEC_CounterEventCountGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Gets the number of stored events of a counter within a range of time.
+ * @param counter instance to query
+ * @param startTime exclusive start of the range
+ * @param endTime inclusive end of the range
+ * @returns Count of events in the range
+ * @see WEC_EventCountRange
+ */
+WEC_COUNT_T WEC_CounterEventCountRange(const WEC_Counter_T *counter,
+        WEC_TIME_T startTime, WEC_TIME_T endTime);
+
+/**
+ * Gets the sum of the weights of the current events of a counter.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns Sum of event weights, or the count of events when the counter does
+ * not track weights
+ * @see WEC_EventSumGet
+ */
+WEC_WEIGHT_T WEC_CounterEventSumGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime);
+
+/**
+ * Gets the time of the oldest stored event of a counter.
+ * @param counter instance to query
+ * @param oldestTime receives the time of the oldest event
+ * @returns error code
+ * @see WEC_OldestTimeGet
+ */
+WEC_ERROR_T WEC_CounterOldestTimeGet(const WEC_Counter_T *counter,
+        WEC_TIME_T *oldestTime);
+
+/**
+ * Clears out all events of a counter.
+ * @param counter instance to clear
+ */
+void WEC_CounterEventsClear(WEC_Counter_T *counter);
+
+/**
+ * Writes the state of a counter to a buffer.
+ * Saves the window limit, start and stop times, whether the window is started
+ * and every stored event, oldest first.  Event times are written as variable
+ * length differences from the previous event, so events close in time take a
+ * byte or two each.  The header records the widths of the time, count and
+ * weight types.  Runtime statistics are not saved.
+ * @param counter instance to save
+ * @param buffer receives the state, WEC_SERIAL_SIZE_MAX() bytes always suffice
+ * @param bufferSize number of bytes available in buffer
+ * @param length receives the number of bytes written
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the state does not fit in buffer.
+ */
+WEC_ERROR_T WEC_CounterSerialize(const WEC_Counter_T *counter, uint8_t buffer[],
+        size_t bufferSize, size_t *length);
+
+/**
+ * Restores the state of a counter from a buffer in a single pass.
+ * The counter keeps its storage, which grows if allocated.  When the saved
+ * events still do not fit, the oldest are dropped.  Saved weights are only
+ * restored into counters that track weights.  Runtime statistics are left as
+ * they were.  States of several counters can
+ * be read one after another from a single buffer using the returned length.
+ * @param counter initialized instance to restore
+ * @param buffer state written by WEC_CounterSerialize()
+ * @param bufferSize number of bytes available in buffer
+ * @param length receives the number of bytes read
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_BUFFER_OVERFLOW when saved events were dropped.
+ * @returns WEC_ERROR when the buffer is truncated or was written by another
+ * version or configuration, the counter is left stopped and empty.
+ */
+WEC_ERROR_T WEC_CounterDeserialize(WEC_Counter_T *counter,
+        const uint8_t buffer[], size_t bufferSize, size_t *length);
+
+/**
+ * Gets a snapshot of the runtime statistics of a counter.
+ * @param counter instance to query
+ * @param stats receives the statistics
+ */
+void WEC_CounterStatsGet(const WEC_Counter_T *counter, WEC_Stats_T *stats);
+
+/**
+ * Adds an alarm level to the count of events of a counter.
+ * @param counter instance to watch
+ * @param threshold storage for the threshold
+ * @param upper count at which the alarm is raised
+ * @param lower count at which the alarm is cleared, below upper
+ * @param callback called on each crossing
+ * @param context passed to callback
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the levels or callback cannot be used, or the counter
+ * has no extensions.
+ * @see WEC_ThresholdAdd
+ */
+WEC_ERROR_T WEC_CounterThresholdAdd(WEC_Counter_T *counter,
+        WEC_Threshold_T *threshold, WEC_COUNT_T upper, WEC_COUNT_T lower,
+        WEC_ThresholdCallback_T callback, void *context);
+
+/**
+ * Removes an alarm level from a counter.
+ * @param counter instance watched
+ * @param threshold threshold to remove, ignored when not added
+ */
+void WEC_CounterThresholdRemove(WEC_Counter_T *counter,
+        WEC_Threshold_T *threshold);
+
+/**
+ * Starts tracking the gaps between consecutive events of a counter.
+ * @param counter instance to track
+ * @param tracker storage for the statistics
+ * @param minQueue storage for capacity entries
+ * @param maxQueue storage for capacity entries
+ * @param capacity number of entries in each queue
+ * @returns WEC_OKAY when no error was detected.
+ * @returns WEC_ERROR when the storage cannot be used, or the counter has no
+ * extensions.
+ * @see WEC_GapStatsEnable
+ */
+WEC_ERROR_T WEC_CounterGapStatsEnable(WEC_Counter_T *counter,
+        WEC_GapTracker_T *tracker, WEC_GapEntry_T minQueue[],
+        WEC_GapEntry_T maxQueue[], size_t capacity);
+
+/**
+ * Stops tracking the gaps between events of a counter.
+ * @param counter instance tracked
+ */
+void WEC_CounterGapStatsDisable(WEC_Counter_T *counter);
+
+/**
+ * Gets the inter-arrival statistics of the events of a counter.
+ * @param counter instance to query
+ * @param currentTime
+ * @param stats receives the statistics
+ * @returns error code
+ * @see WEC_GapStatsGet
+ */
+WEC_ERROR_T WEC_CounterGapStatsGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime, WEC_GapStats_T *stats);
+
+/**
+ * Gets the value of the current window limit of a counter.
+ * @param counter instance to query
+ * @returns the current window limit
+ */
+WEC_TIME_T WEC_CounterWindowLimitGet(const WEC_Counter_T *counter);
+
+/**
+ * Sets the maximum length for the measurement window of a counter.
+ * @param counter instance to update
+ * @param windowLimit maximum length of measurement window
+ * @return error
+ */
+WEC_ERROR_T WEC_CounterWindowLimitSet(WEC_Counter_T *counter,
+        WEC_TIME_T windowLimit);
+
+/**
+ * Gets the value of the current lateness limit of a counter.
+ * @param counter instance to query
+ * @returns the current lateness limit
+ */
+WEC_TIME_T WEC_CounterLatenessLimitGet(const WEC_Counter_T *counter);
+
+/**
+ * Sets how much older than its newest event an event added to a counter may
+ * be.
+ * @param counter instance to update
+ * @param latenessLimit most an event may be older than the newest event
+ * @return error
+ * @see WEC_LatenessLimitSet
+ */
+WEC_ERROR_T WEC_CounterLatenessLimitSet(WEC_Counter_T *counter,
+        WEC_TIME_T latenessLimit);
+
+/**
+ * Starts measurement on a counter.
+ * @param counter instance to start
+ * @param startTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_CounterWindowStart(WEC_Counter_T *counter,
+        WEC_TIME_T startTime);
+
+/**
+ * Stops measurement on a counter.
+ * @param counter instance to stop
+ * @param stopTime
+ * @returns error code
+ */
+WEC_ERROR_T WEC_CounterWindowStop(WEC_Counter_T *counter, WEC_TIME_T stopTime);
+
+/**
+ * Gets length (in time) of the measurement window of a counter.
+ * @param counter instance to query
+ * @param currentTime
+ * @returns actual length of measurement window
+ */
+WEC_TIME_T WEC_CounterWindowTimeGet(WEC_Counter_T *counter,
+        WEC_TIME_T currentTime);
+
+#    ifdef __cplusplus
+}
+#    endif
 
 #endif // WINDOWED_EVENT_COUNTER_H
 
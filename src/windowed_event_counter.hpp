@@ -0,0 +1,395 @@
+/**
+ * @file
+ * windowed_event_counter.hpp
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Header only C++ counter of events within a window in time.
+ *
+ * Behaves like a WEC_Counter_T from windowed_event_counter.c, but with the
+ * capacity, time type and count type chosen per instance at compile time and
+ * no global state.  A power of two capacity indexes the buffer with a mask.
+ * Requires C++17.
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Abbreviations Used:
+ * WEC - Windowed Event Counter
+ */
+
+#ifndef WINDOWED_EVENT_COUNTER_HPP    // Guards against multiple inclusion
+#    define WINDOWED_EVENT_COUNTER_HPP
+
+//
+// Section: Included Files
+//
+
+#    include "windowed_event_counter.h"
+#    include <algorithm>
+#    include <array>
+#    include <cstddef>
+#    include <cstdint>
+#    include <limits>
+#    include <new>
+#    include <type_traits>
+#    include <vector>
+
+namespace wec {
+
+//
+// Section: Data Types
+//
+
+/// What a counter does with an event added to a full buffer
+enum class overflow_policy {
+    /// Drop the oldest event, as the C counters do without an allocator
+    drop_oldest,
+    /// Keep the stored events and leave the new one out
+    reject,
+    /// Double the buffer, dropping the oldest event only once the count type
+    /// cannot hold a larger buffer or memory runs out
+    grow,
+};
+
+/**
+ * Windowed event counter.
+ * @tparam Capacity number of events stored, the initial number with
+ * overflow_policy::grow
+ * @tparam TimeT unsigned type used to store event times
+ * @tparam CountT unsigned type used to count events
+ * @tparam Policy handling of events added to a full buffer
+ */
+template <std::size_t Capacity, typename TimeT = std::uint32_t,
+        typename CountT = std::uint8_t,
+        overflow_policy Policy = overflow_policy::drop_oldest>
+class windowed_event_counter {
+    static_assert(std::is_unsigned_v<TimeT>, "TimeT must be unsigned");
+    static_assert(std::is_unsigned_v<CountT>, "CountT must be unsigned");
+    static_assert(0U < Capacity, "Capacity must not be 0");
+    static_assert(Capacity <= std::numeric_limits<CountT>::max(),
+            "CountT must be able to count a full buffer");
+
+public:
+    using time_type = TimeT;
+    using count_type = CountT;
+
+    windowed_event_counter() = default;
+
+    windowed_event_counter(const windowed_event_counter &) = default;
+
+    windowed_event_counter &operator=(const windowed_event_counter &) = default;
+
+    /**
+     * Takes over the events and window of another counter.
+     * The source is left stopped and empty, with a window limit of 0, and can
+     * be used again.  A growing source gives up its buffer and allocates a new
+     * one on its next event.
+     */
+    windowed_event_counter(windowed_event_counter &&other) noexcept
+            : events_(std::move(other.events_)), startTime_(other.startTime_),
+            stopTime_(other.stopTime_), windowLimit_(other.windowLimit_),
+            count_(other.count_), head_(other.head_), tail_(other.tail_),
+            started_(other.started_) {
+        other.moved_from_reset();
+    }
+
+    windowed_event_counter &operator=(windowed_event_counter &&other) noexcept {
+        if (this != &other) {
+            events_ = std::move(other.events_);
+            startTime_ = other.startTime_;
+            stopTime_ = other.stopTime_;
+            windowLimit_ = other.windowLimit_;
+            count_ = other.count_;
+            head_ = other.head_;
+            tail_ = other.tail_;
+            started_ = other.started_;
+            other.moved_from_reset();
+        }
+        return *this;
+    }
+
+    /**
+     * Updates event count with a new event.
+     * @param eventTime time at which the event was detected
+     * @returns WEC_OKAY when no error was detected.
+     * @returns WEC_NOT_STARTED when the window is not started.
+     * @returns WEC_BUFFER_OVERFLOW when event was added to a full buffer.
+     */
+    WEC_ERROR_T event_add(TimeT eventTime) noexcept {
+        if (!window_shift(eventTime)) {
+            return WEC_NOT_STARTED;
+        }
+        WEC_ERROR_T result = WEC_OKAY;
+        if (capacity() <= count_) {
+            if constexpr (Policy == overflow_policy::reject) {
+                return WEC_BUFFER_OVERFLOW;
+            } else if (!grow()) {
+                if (0U == capacity()) {
+                    return WEC_BUFFER_OVERFLOW; // Moved from, out of memory
+                }
+                tail_ = index_advance(tail_, 1U); // Drop the oldest
+                count_--;
+                result = WEC_BUFFER_OVERFLOW;
+            }
+        }
+        events_[slot(head_)] = eventTime;
+        head_ = index_advance(head_, 1U);
+        count_++;
+        return result;
+    }
+
+    /**
+     * Gets the current number of events.
+     * Removes expired events and returns the count of remaining events.
+     * @param currentTime
+     * @returns Count of events
+     */
+    CountT event_count_get(TimeT currentTime) noexcept {
+        (void) window_shift(currentTime);
+        return count_;
+    }
+
+    /// Clears out all events.
+    void events_clear() noexcept {
+        count_ = 0U;
+        head_ = 0U;
+        tail_ = 0U;
+    }
+
+    /// Gets the value of the current window limit.
+    TimeT window_limit_get() const noexcept {
+        return windowLimit_;
+    }
+
+    /**
+     * Sets the maximum length for the measurement window
+     * @param windowLimit maximum length of measurement window
+     * @return error
+     */
+    WEC_ERROR_T window_limit_set(TimeT windowLimit) noexcept {
+        if (started_) {
+            return WEC_ALREADY_STARTED;
+        }
+        windowLimit_ = windowLimit;
+        return WEC_OKAY;
+    }
+
+    /**
+     * Starts measurement
+     * @param startTime
+     * @returns error code
+     */
+    WEC_ERROR_T window_start(TimeT startTime) noexcept {
+        if (started_) {
+            return WEC_ALREADY_STARTED;
+        }
+        started_ = true;
+        startTime_ = startTime;
+        return WEC_OKAY;
+    }
+
+    /**
+     * Stops measurement
+     * @param stopTime
+     * @returns error code
+     */
+    WEC_ERROR_T window_stop(TimeT stopTime) noexcept {
+        if (!started_) {
+            return WEC_NOT_STARTED;
+        }
+        (void) window_shift(stopTime);
+        started_ = false;
+        stopTime_ = stopTime;
+        return WEC_OKAY;
+    }
+
+    /**
+     * Gets length (in time) of the measurement window
+     * @param currentTime
+     * @returns actual length of measurement window
+     */
+    TimeT window_time_get(TimeT currentTime) noexcept {
+        if (started_) {
+            startTime_ = start_time_update(currentTime);
+            return static_cast<TimeT>(currentTime - startTime_);
+        }
+        return static_cast<TimeT>(stopTime_ - startTime_);
+    }
+
+    /// Gets the number of events the buffer holds before overflowing.
+    std::size_t capacity() const noexcept {
+        if constexpr (Policy == overflow_policy::grow) {
+            return events_.size();
+        } else {
+            return Capacity;
+        }
+    }
+
+private:
+    /// Fixed storage, except when growing
+    using storage_type = std::conditional_t<Policy == overflow_policy::grow,
+            std::vector<TimeT>, std::array<TimeT, Capacity>>;
+
+    /// Indices run freely and are masked on access while every capacity is a
+    /// power of two
+    static constexpr bool masked = (0U == (Capacity & (Capacity - 1U)));
+
+    static storage_type storage_make() {
+        if constexpr (Policy == overflow_policy::grow) {
+            return storage_type(Capacity);
+        } else {
+            return storage_type{};
+        }
+    }
+
+    std::size_t slot(CountT index) const noexcept {
+        if constexpr (masked) {
+            return index & (capacity() - 1U);
+        } else {
+            return index;
+        }
+    }
+
+    CountT index_advance(CountT index, CountT steps) const noexcept {
+        if constexpr (masked) {
+            return static_cast<CountT>(index + steps);
+        } else {
+            std::size_t advanced = std::size_t(index) + steps;
+            if (advanced >= capacity()) {
+                advanced -= capacity();
+            }
+            return static_cast<CountT>(advanced);
+        }
+    }
+
+    TimeT start_time_update(TimeT currentTime) const noexcept {
+        if (static_cast<TimeT>(currentTime - startTime_) >= windowLimit_) {
+            return static_cast<TimeT>(currentTime - windowLimit_);
+        }
+        return startTime_;
+    }
+
+    bool window_shift(TimeT currentTime) noexcept {
+        if (!started_) {
+            return false;
+        }
+        startTime_ = start_time_update(currentTime);
+        expire(currentTime);
+        return true;
+    }
+
+    /// Removes events equal to or older than the window limit in O(log n)
+    void expire(TimeT currentTime) noexcept {
+        auto inWindow = [&](CountT index) {
+            return static_cast<TimeT>(currentTime - events_[slot(index)])
+                    < windowLimit_;
+        };
+        if ((0U == count_) || inWindow(tail_)) {
+            return;
+        }
+        CountT low = 1U;
+        CountT high = count_;
+        while (low < high) {
+            CountT mid = static_cast<CountT>(low + ((high - low) / 2U));
+            if (inWindow(index_advance(tail_, mid))) {
+                high = mid;
+            } else {
+                low = static_cast<CountT>(mid + 1U);
+            }
+        }
+        count_ = static_cast<CountT>(count_ - low);
+        tail_ = index_advance(tail_, low);
+    }
+
+    /// Resets every member but the storage to the default state and empties
+    /// storage that was moved out
+    void moved_from_reset() noexcept {
+        if constexpr (Policy == overflow_policy::grow) {
+            events_.clear();
+        }
+        events_clear();
+        startTime_ = 0U;
+        stopTime_ = 0U;
+        windowLimit_ = 0U;
+        started_ = false;
+    }
+
+    /// Doubles the buffer, unwrapping the events onto its start.  A buffer
+    /// moved out is replaced with one of the initial capacity.
+    bool grow() noexcept {
+        if constexpr (Policy == overflow_policy::grow) {
+            std::size_t grown = (0U < capacity()) ? (capacity() * 2U)
+                    : Capacity;
+            if (grown > std::numeric_limits<CountT>::max()) {
+                return false;
+            }
+            try {
+                storage_type events(grown);
+                for (CountT i = 0U; i < count_; i++) {
+                    events[i] = events_[slot(index_advance(tail_, i))];
+                }
+                events_.swap(events);
+            } catch (const std::bad_alloc &) {
+                return false;
+            }
+            tail_ = 0U;
+            head_ = count_;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    /// Stores the time of each event
+    storage_type events_ = storage_make();
+    /// Timestamp marking the start of the measurement window
+    TimeT startTime_ = 0U;
+    /// Timestamp marking the end of the measurement window
+    TimeT stopTime_ = 0U;
+    /// Limit to the length of the time window
+    TimeT windowLimit_ = 0U;
+    /// current count of events
+    CountT count_ = 0U;
+    /// index of the position to add the next event
+    CountT head_ = 0U;
+    /// index of the oldest event
+    CountT tail_ = 0U;
+    /// Indicates when window is started and running
+    bool started_ = false;
+};
+
+} // namespace wec
+
+#endif // WINDOWED_EVENT_COUNTER_HPP
+
+//
+// End of File
+//
+
@@ -0,0 +1,119 @@
+#include "unity.h"
+#include "wec_approx_counter.h"
+
+#define ERROR_INVERSE (10U)
+#define LEVEL_COUNT (20U)
+
+static WEC_ApproxCounter_T counter;
+static WEC_TIME_T bucketTimes[LEVEL_COUNT
+        * WEC_APPROX_LEVEL_CAPACITY(ERROR_INVERSE)];
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ApproxCounterInit(&counter, bucketTimes,
+            LEVEL_COUNT, ERROR_INVERSE));
+    (void) WEC_ApproxCounterWindowLimitSet(&counter, 100U);
+}
+
+void tearDown(void) {
+    (void) WEC_ApproxCounterWindowStop(&counter, 0U);
+}
+
+void test_Init_should_returnError_when_storageIsUnusable(void) {
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ApproxCounterInit(&counter, NULL, LEVEL_COUNT, ERROR_INVERSE));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ApproxCounterInit(&counter, bucketTimes, 0U, ERROR_INVERSE));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ApproxCounterInit(&counter, bucketTimes,
+            WEC_APPROX_LEVELS_MAX + 1U, ERROR_INVERSE));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ApproxCounterInit(&counter, bucketTimes, LEVEL_COUNT, 0U));
+}
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_ApproxCounterEventAdd(&counter, 1U));
+    TEST_ASSERT_EQUAL(0U, WEC_ApproxCounterEventCountGet(&counter, 1U));
+}
+
+void test_EventCountGet_should_beExact_when_noBucketsMerged(void) {
+    (void) WEC_ApproxCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T t = 0U; t < 6U; t++) {
+        (void) WEC_ApproxCounterEventAdd(&counter, t * 10U);
+    }
+    TEST_ASSERT_EQUAL(6U, WEC_ApproxCounterEventCountGet(&counter, 99U));
+    TEST_ASSERT_EQUAL(5U, WEC_ApproxCounterEventCountGet(&counter, 100U));
+    TEST_ASSERT_EQUAL(1U, WEC_ApproxCounterEventCountGet(&counter, 149U));
+    TEST_ASSERT_EQUAL(0U, WEC_ApproxCounterEventCountGet(&counter, 150U));
+}
+
+void test_EventCountGet_should_stayWithinTheErrorBound(void) {
+    WEC_TIME_T limit = 100000U;
+    uint32_t perTick = 20U;
+    (void) WEC_ApproxCounterWindowLimitSet(&counter, limit);
+    (void) WEC_ApproxCounterWindowStart(&counter, 0U);
+
+    // Two million events, forty thousand buckets worth of exact storage
+    for (WEC_TIME_T t = 0U; t < 100000U; t++) {
+        for (uint32_t i = 0U; i < perTick; i++) {
+            TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ApproxCounterEventAdd(&counter, t));
+        }
+        if (0U == (t % 997U)) {
+            uint32_t exact = (t + 1U) * perTick;
+            uint32_t estimate = WEC_ApproxCounterEventCountGet(&counter, t);
+            TEST_ASSERT_UINT32_WITHIN(exact / ERROR_INVERSE, exact, estimate);
+        }
+    }
+    for (WEC_TIME_T t = 0U; t < 100000U; t += 997U) {
+        uint32_t exact = (99999U - t) * perTick;
+        uint32_t estimate = WEC_ApproxCounterEventCountGet(&counter, t + limit);
+        TEST_ASSERT_UINT32_WITHIN(exact / ERROR_INVERSE, exact, estimate);
+    }
+    TEST_ASSERT_TRUE(sizeof (bucketTimes) < (256U * sizeof (WEC_TIME_T)));
+}
+
+void test_EventAdd_should_returnOverflow_when_largestLevelIsFull(void) {
+    WEC_TIME_T small[2U * WEC_APPROX_LEVEL_CAPACITY(2U)];
+    WEC_ERROR_T err = WEC_OKAY;
+    uint32_t added = 0U;
+    (void) WEC_ApproxCounterInit(&counter, small, 2U, 2U);
+    (void) WEC_ApproxCounterWindowLimitSet(&counter, 100U);
+    (void) WEC_ApproxCounterWindowStart(&counter, 0U);
+    while (WEC_OKAY == err) {
+        err = WEC_ApproxCounterEventAdd(&counter, 1U);
+        added++;
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, err);
+    TEST_ASSERT_TRUE(added > WEC_ApproxCounterEventCountGet(&counter, 1U));
+}
+
+void test_EventCountGet_should_workAroundTimeOverflow(void) {
+    WEC_TIME_T time = 0U - 50U;
+    (void) WEC_ApproxCounterWindowStart(&counter, time);
+    for (WEC_TIME_T t = 0U; t < 100U; t++) {
+        (void) WEC_ApproxCounterEventAdd(&counter, time + t);
+    }
+    TEST_ASSERT_UINT32_WITHIN(10U, 100U,
+            WEC_ApproxCounterEventCountGet(&counter, time + 99U));
+    TEST_ASSERT_UINT32_WITHIN(5U, 50U,
+            WEC_ApproxCounterEventCountGet(&counter, time + 149U));
+    TEST_ASSERT_EQUAL(0U, WEC_ApproxCounterEventCountGet(&counter, time + 199U));
+}
+
+void test_EventCountGet_should_notExpire_when_stopped(void) {
+    (void) WEC_ApproxCounterWindowStart(&counter, 0U);
+    (void) WEC_ApproxCounterEventAdd(&counter, 5U);
+    (void) WEC_ApproxCounterWindowStop(&counter, 10U);
+    TEST_ASSERT_EQUAL(1U, WEC_ApproxCounterEventCountGet(&counter, 1000U));
+    TEST_ASSERT_EQUAL(10U, WEC_ApproxCounterWindowTimeGet(&counter, 1000U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_storageIsUnusable);
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_EventCountGet_should_beExact_when_noBucketsMerged);
+    RUN_TEST(test_EventCountGet_should_stayWithinTheErrorBound);
+    RUN_TEST(test_EventAdd_should_returnOverflow_when_largestLevelIsFull);
+    RUN_TEST(test_EventCountGet_should_workAroundTimeOverflow);
+    RUN_TEST(test_EventCountGet_should_notExpire_when_stopped);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+#include "unity.h"
+#include "wec_bucket_counter.h"
+
+static WEC_BucketCounter_T counter;
+
+void setUp(void) {
+    WEC_BucketCounterInit(&counter);
+    (void) WEC_BucketCounterWindowLimitSet(&counter,
+            WEC_BUCKET_RESOLUTION * 10U);
+}
+
+void tearDown(void) {
+    (void) WEC_BucketCounterWindowStop(&counter, 0U);
+}
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_BucketCounterEventAdd(&counter, 1U));
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, 1U));
+}
+
+void test_EventAdd_should_countEveryEvent_when_burstExceedsEventBuffer(void) {
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    for (uint32_t i = 0U; i < 10U * WEC_EVENT_BUFFER_SIZE; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_BucketCounterEventAdd(&counter, 5U));
+    }
+    TEST_ASSERT_EQUAL(10U * WEC_EVENT_BUFFER_SIZE,
+            WEC_BucketCounterEventCountGet(&counter, 5U));
+}
+
+void test_EventCountGet_should_dropBucketsThatLeftTheWindow(void) {
+    WEC_TIME_T limit = WEC_BUCKET_RESOLUTION * 10U;
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 9U);
+    (void) WEC_BucketCounterEventAdd(&counter, 10U);
+
+    // Bucket [0, 10) is counted while any of its times is inside the window
+    TEST_ASSERT_EQUAL(3U, WEC_BucketCounterEventCountGet(&counter, limit + 8U));
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, limit + 9U));
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, limit + 18U));
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, limit + 19U));
+}
+
+void test_EventCountGet_should_dropBuckets_when_limitIsNotAMultiple(void) {
+    // Buckets of 7 need only 15 buckets to cover the window
+    (void) WEC_BucketCounterWindowLimitSet(&counter, 100U);
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 7U);
+
+    TEST_ASSERT_EQUAL(2U, WEC_BucketCounterEventCountGet(&counter, 105U));
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, 106U));
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, 112U));
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, 113U));
+}
+
+void test_EventCountGet_should_beExact_when_limitIsBelowResolution(void) {
+    (void) WEC_BucketCounterWindowLimitSet(&counter, 10U);
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 0U);
+
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, 9U));
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, 10U));
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, 15U));
+}
+
+void test_EventCountGet_should_stayWithinOneBucket_of_exactCount(void) {
+    static const WEC_TIME_T limits[] = {10U, 100U, 161U};
+    for (size_t i = 0U; i < (sizeof (limits) / sizeof (limits[0])); i++) {
+        WEC_TIME_T limit = limits[i];
+        WEC_TIME_T width = (limit + WEC_BUCKET_RESOLUTION - 1U)
+                / WEC_BUCKET_RESOLUTION;
+        WEC_BucketCounterInit(&counter);
+        (void) WEC_BucketCounterWindowLimitSet(&counter, limit);
+        (void) WEC_BucketCounterWindowStart(&counter, 0U);
+        for (WEC_TIME_T now = 0U; now < 400U; now++) {
+            if (now < 200U) {
+                (void) WEC_BucketCounterEventAdd(&counter, now);
+            }
+            WEC_TIME_T oldest = (now < limit) ? 0U : (now - limit + 1U);
+            WEC_TIME_T newest = (now < 200U) ? now : 199U;
+            uint32_t exact = (oldest <= newest) ? (newest - oldest + 1U) : 0U;
+            uint32_t count = WEC_BucketCounterEventCountGet(&counter, now);
+            TEST_ASSERT_TRUE(exact <= count);
+            TEST_ASSERT_TRUE(count <= exact + width);
+        }
+    }
+}
+
+void test_EventCountGet_should_dropAllBuckets_when_idleLongerThanWindow(void) {
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 1U);
+    (void) WEC_BucketCounterEventAdd(&counter, 50U);
+    TEST_ASSERT_EQUAL(0U, WEC_BucketCounterEventCountGet(&counter, 100000U));
+
+    (void) WEC_BucketCounterEventAdd(&counter, 100001U);
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, 100001U));
+}
+
+void test_EventCountGet_should_workAroundTimeOverflow(void) {
+    WEC_TIME_T time = 0U - 35U;
+    (void) WEC_BucketCounterWindowStart(&counter, time);
+    (void) WEC_BucketCounterEventAdd(&counter, time);
+    (void) WEC_BucketCounterEventAdd(&counter, time + 40U);
+    TEST_ASSERT_EQUAL(2U, WEC_BucketCounterEventCountGet(&counter, time + 40U));
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter,
+            time + (WEC_BUCKET_RESOLUTION * 10U) + 10U));
+}
+
+void test_EventCountGet_should_notExpire_when_stopped(void) {
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    (void) WEC_BucketCounterEventAdd(&counter, 1U);
+    (void) WEC_BucketCounterWindowStop(&counter, 2U);
+    TEST_ASSERT_EQUAL(1U, WEC_BucketCounterEventCountGet(&counter, 100000U));
+}
+
+void test_WindowLimitSet_should_returnAlreadyStarted_when_started(void) {
+    (void) WEC_BucketCounterWindowStart(&counter, 0U);
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED,
+            WEC_BucketCounterWindowLimitSet(&counter, 5U));
+    TEST_ASSERT_EQUAL(WEC_BUCKET_RESOLUTION * 10U,
+            WEC_BucketCounterWindowLimitGet(&counter));
+}
+
+void test_WindowTimeGet_should_returnNoLargerThanWindowLimit(void) {
+    (void) WEC_BucketCounterWindowStart(&counter, 100U);
+    TEST_ASSERT_EQUAL(50U, WEC_BucketCounterWindowTimeGet(&counter, 150U));
+    TEST_ASSERT_EQUAL(WEC_BUCKET_RESOLUTION * 10U,
+            WEC_BucketCounterWindowTimeGet(&counter, 100000U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_EventAdd_should_countEveryEvent_when_burstExceedsEventBuffer);
+    RUN_TEST(test_EventCountGet_should_dropBucketsThatLeftTheWindow);
+    RUN_TEST(test_EventCountGet_should_dropBuckets_when_limitIsNotAMultiple);
+    RUN_TEST(test_EventCountGet_should_beExact_when_limitIsBelowResolution);
+    RUN_TEST(test_EventCountGet_should_stayWithinOneBucket_of_exactCount);
+    RUN_TEST(test_EventCountGet_should_dropAllBuckets_when_idleLongerThanWindow);
+    RUN_TEST(test_EventCountGet_should_workAroundTimeOverflow);
+    RUN_TEST(test_EventCountGet_should_notExpire_when_stopped);
+    RUN_TEST(test_WindowLimitSet_should_returnAlreadyStarted_when_started);
+    RUN_TEST(test_WindowTimeGet_should_returnNoLargerThanWindowLimit);
+    return UNITY_END();
+}
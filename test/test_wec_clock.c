@@ -0,0 +1,128 @@
+#include "unity.h"
+#include "wec_clock.h"
+#include <time.h>
+
+#define CAPACITY (16U)
+
+static WEC_Clock_T source;
+static WEC_Counter_T counter;
+static WEC_CounterExtensions_T extensions;
+static WEC_TIME_T buffer[CAPACITY];
+
+/// Sleeps for a number of milliseconds
+static void Sleep(long ms) {
+    const struct timespec delay = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (ms % 1000) * 1000000L,
+    };
+    (void) nanosleep(&delay, NULL);
+}
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterInit(&counter, buffer, CAPACITY));
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+}
+
+void tearDown(void) {
+    WEC_CounterDeinit(&counter);
+}
+
+void test_Now_should_returnError_when_noClockIsSet(void) {
+    WEC_ClockMockInit(&source, 0U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterClockSet(&counter, &source));
+    (void) WEC_CounterExtensionsSet(&counter, &extensions);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterEventAddNow(&counter));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGetNow(&counter));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counter, 0U));
+}
+
+void test_Now_should_readTheMockClock(void) {
+    WEC_ClockMockInit(&source, 1000U);
+    (void) WEC_CounterExtensionsSet(&counter, &extensions);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterClockSet(&counter, &source));
+    (void) WEC_CounterWindowStart(&counter, WEC_ClockNow(&source));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAddNow(&counter));
+    WEC_ClockMockAdvance(&source, 60U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAddNow(&counter));
+    TEST_ASSERT_EQUAL(2U, WEC_CounterEventCountGetNow(&counter));
+    // The first event is exactly the window limit old
+    WEC_ClockMockAdvance(&source, 40U);
+    TEST_ASSERT_EQUAL(1U, WEC_CounterEventCountGetNow(&counter));
+    WEC_ClockMockSet(&source, 1160U);
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGetNow(&counter));
+    TEST_ASSERT_EQUAL(1160U, WEC_ClockNow(&source));
+}
+
+void test_Now_should_useTheDefaultCounter(void) {
+    WEC_ClockMockInit(&source, (WEC_TIME_T) 0U - 10U);
+    WEC_ClockSet(&source);
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_WindowStart(WEC_ClockNow(&source));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddNow());
+    WEC_ClockMockAdvance(&source, 20U); // Runs through wrap around
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddNow());
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountGetNow());
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountGet(10U));
+    (void) WEC_WindowStop(WEC_ClockNow(&source));
+    WEC_ClockSet(NULL);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_EventAddNow());
+}
+
+void test_Init_should_returnError_when_unitIsZero(void) {
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ClockCoarseInit(&source, 0U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ClockCachedInit(&source, 0U, 1000000U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ClockCachedInit(&source, 1000000U, 0U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ClockTscInit(&source, 0U));
+}
+
+void test_CoarseClock_should_followTheMonotonicClock(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ClockCoarseInit(&source, 1000000U));
+    WEC_TIME_T start = WEC_ClockNow(&source);
+    Sleep(50);
+    WEC_TIME_T elapsed = WEC_ClockNow(&source) - start;
+    TEST_ASSERT_TRUE((elapsed >= 40U) && (elapsed < 1000U));
+    WEC_ClockDeinit(&source);
+}
+
+void test_CachedClock_should_advanceEveryPeriod(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_ClockCachedInit(&source, 1000000U, 1000000U));
+    WEC_TIME_T start = WEC_ClockNow(&source);
+    Sleep(50);
+    WEC_TIME_T elapsed = WEC_ClockNow(&source) - start;
+    TEST_ASSERT_TRUE((elapsed >= 30U) && (elapsed < 1000U));
+    WEC_ClockDeinit(&source);
+    WEC_ClockDeinit(&source);
+}
+
+void test_TscClock_should_matchTheCoarseClock(void) {
+    WEC_Clock_T coarse;
+    // Processors without an invariant counter have nothing to check
+    if (WEC_OKAY != WEC_ClockTscInit(&source, 1000U)) {
+        return;
+    }
+    (void) WEC_ClockCoarseInit(&coarse, 1000U);
+    WEC_TIME_T tscStart = WEC_ClockNow(&source);
+    WEC_TIME_T coarseStart = WEC_ClockNow(&coarse);
+    Sleep(50);
+    int64_t tscElapsed = (int64_t) (WEC_TIME_T) (WEC_ClockNow(&source)
+            - tscStart);
+    int64_t coarseElapsed = (int64_t) (WEC_TIME_T) (WEC_ClockNow(&coarse)
+            - coarseStart);
+    // Within the resolution of the coarse clock plus calibration error
+    TEST_ASSERT_INT_WITHIN(10000, coarseElapsed, tscElapsed);
+    TEST_ASSERT_TRUE(tscElapsed >= 40000);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Now_should_returnError_when_noClockIsSet);
+    RUN_TEST(test_Now_should_readTheMockClock);
+    RUN_TEST(test_Now_should_useTheDefaultCounter);
+    RUN_TEST(test_Init_should_returnError_when_unitIsZero);
+    RUN_TEST(test_CoarseClock_should_followTheMonotonicClock);
+    RUN_TEST(test_CachedClock_should_advanceEveryPeriod);
+    RUN_TEST(test_TscClock_should_matchTheCoarseClock);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+#include "unity.h"
+#include "wec_compact_counter.h"
+
+#define STORAGE_SIZE (64U)
+
+static WEC_CompactCounter_T counter;
+static uint16_t storage[STORAGE_SIZE / sizeof (uint16_t)];
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CompactCounterInit(&counter, storage, STORAGE_SIZE, 100U));
+}
+
+void tearDown(void) {
+    (void) WEC_CompactCounterWindowStop(&counter, 0U);
+}
+
+void test_Init_should_returnError_when_storageOrLimitIsUnusable(void) {
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CompactCounterInit(&counter, NULL, STORAGE_SIZE, 100U));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CompactCounterInit(&counter, storage, STORAGE_SIZE, 0U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CompactCounterInit(&counter, storage,
+            STORAGE_SIZE, WEC_COMPACT_LIMIT_16 + 1U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CompactCounterInit(&counter, storage, 1U,
+            WEC_COMPACT_LIMIT_8 + 1U));
+}
+
+void test_Init_should_pickOffsetWidthFromTheWindowLimit(void) {
+    TEST_ASSERT_EQUAL(STORAGE_SIZE, WEC_CompactCounterCapacityGet(&counter));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CompactCounterWindowLimitSet(&counter,
+            WEC_COMPACT_LIMIT_8 + 1U));
+    TEST_ASSERT_EQUAL(STORAGE_SIZE / 2U,
+            WEC_CompactCounterCapacityGet(&counter));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CompactCounterWindowLimitSet(&counter,
+            WEC_COMPACT_LIMIT_16 + 1U));
+    TEST_ASSERT_EQUAL(WEC_COMPACT_LIMIT_8 + 1U,
+            WEC_CompactCounterWindowLimitGet(&counter));
+    (void) WEC_CompactCounterWindowStart(&counter, 0U);
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED,
+            WEC_CompactCounterWindowLimitSet(&counter, 10U));
+}
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED,
+            WEC_CompactCounterEventAdd(&counter, 1U));
+    TEST_ASSERT_EQUAL(0U, WEC_CompactCounterEventCountGet(&counter, 1U));
+}
+
+void test_EventCountGet_should_expireEvents_when_offsetsAreRebased(void) {
+    (void) WEC_CompactCounterWindowStart(&counter, 0U);
+    // Ten thousand ticks run the 8 bit offsets around many times
+    for (WEC_TIME_T t = 0U; t < 10000U; t += 3U) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CompactCounterEventAdd(&counter, t));
+        TEST_ASSERT_EQUAL(t / 3U < 33U ? t / 3U + 1U : 34U,
+                WEC_CompactCounterEventCountGet(&counter, t));
+    }
+    // Newest event at 9999, events at 9903 and older have expired
+    TEST_ASSERT_EQUAL(33U, WEC_CompactCounterEventCountGet(&counter, 10002U));
+    TEST_ASSERT_EQUAL(1U, WEC_CompactCounterEventCountGet(&counter, 10098U));
+    TEST_ASSERT_EQUAL(0U, WEC_CompactCounterEventCountGet(&counter, 10099U));
+}
+
+void test_EventAdd_should_dropOldest_when_full(void) {
+    (void) WEC_CompactCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T t = 0U; t < STORAGE_SIZE; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CompactCounterEventAdd(&counter, t));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_CompactCounterEventAdd(&counter, STORAGE_SIZE));
+    TEST_ASSERT_EQUAL(STORAGE_SIZE,
+            WEC_CompactCounterEventCountGet(&counter, STORAGE_SIZE));
+    TEST_ASSERT_EQUAL(STORAGE_SIZE - 1U,
+            WEC_CompactCounterEventCountGet(&counter, 101U));
+}
+
+void test_EventCountGet_should_matchTheFullCounter(void) {
+    WEC_Counter_T reference;
+    WEC_TIME_T referenceBuffer[16];
+    static uint8_t compactStorage[16 * sizeof (uint16_t)];
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CompactCounterInit(&counter,
+            compactStorage, 16U * sizeof (uint16_t), 1000U));
+    TEST_ASSERT_EQUAL(16U, WEC_CompactCounterCapacityGet(&counter));
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInit(&reference, referenceBuffer, 16U));
+    (void) WEC_CounterWindowLimitSet(&reference, 1000U);
+
+    WEC_TIME_T now = (WEC_TIME_T) 0U - 5000U; // Runs through wrap around
+    (void) WEC_CompactCounterWindowStart(&counter, now);
+    (void) WEC_CounterWindowStart(&reference, now);
+    uint32_t seed = 7U;
+    for (int i = 0; i < 20000; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        now += (seed >> 16) % 150U;
+        if (0U == ((seed >> 8) % 3U)) {
+            TEST_ASSERT_EQUAL(WEC_CounterEventCountGet(&reference, now),
+                    WEC_CompactCounterEventCountGet(&counter, now));
+        } else {
+            TEST_ASSERT_EQUAL(WEC_CounterEventAdd(&reference, now),
+                    WEC_CompactCounterEventAdd(&counter, now));
+        }
+        TEST_ASSERT_EQUAL(WEC_CounterWindowTimeGet(&reference, now),
+                WEC_CompactCounterWindowTimeGet(&counter, now));
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_storageOrLimitIsUnusable);
+    RUN_TEST(test_Init_should_pickOffsetWidthFromTheWindowLimit);
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_EventCountGet_should_expireEvents_when_offsetsAreRebased);
+    RUN_TEST(test_EventAdd_should_dropOldest_when_full);
+    RUN_TEST(test_EventCountGet_should_matchTheFullCounter);
+    return UNITY_END();
+}
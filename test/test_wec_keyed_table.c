@@ -0,0 +1,175 @@
+#include "unity.h"
+#include "wec_keyed_table.h"
+
+#define ENTRIES (16U)
+#define KEY_CAPACITY (4U)
+#define WINDOW_LIMIT (100U)
+
+static WEC_KeyedTable_T table;
+static WEC_KeyedEntry_T entries[ENTRIES];
+static WEC_TIME_T buffer[ENTRIES * KEY_CAPACITY];
+
+void setUp(void) {
+    (void) WEC_KeyedTableInit(&table, entries, ENTRIES, buffer, KEY_CAPACITY,
+            WINDOW_LIMIT);
+}
+
+void tearDown(void) {
+}
+
+void test_Init_should_returnError_when_entryCountIsNotAPowerOfTwo(void) {
+    WEC_KeyedTable_T other;
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_KeyedTableInit(&other, entries, 12U,
+            buffer, KEY_CAPACITY, WINDOW_LIMIT));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_KeyedTableInit(&other, entries, 1U,
+            buffer, KEY_CAPACITY, WINDOW_LIMIT));
+}
+
+void test_EventCountGet_should_return0_when_keyIsUnknown(void) {
+    TEST_ASSERT_EQUAL(0U, WEC_KeyedTableEventCountGet(&table, 42U, 0U));
+    TEST_ASSERT_EQUAL(0U, WEC_KeyedTableKeyCountGet(&table));
+}
+
+void test_EventAdd_should_countEachKeySeparately(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 1U, 10U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 2U, 20U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 2U, 30U));
+
+    TEST_ASSERT_EQUAL(1U, WEC_KeyedTableEventCountGet(&table, 1U, 30U));
+    TEST_ASSERT_EQUAL(2U, WEC_KeyedTableEventCountGet(&table, 2U, 30U));
+    TEST_ASSERT_EQUAL(2U, WEC_KeyedTableKeyCountGet(&table));
+}
+
+void test_EventAdd_should_overflowPerKey(void) {
+    for (WEC_TIME_T time = 0U; time < KEY_CAPACITY; time++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 7U, time));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_KeyedTableEventAdd(&table, 7U, KEY_CAPACITY));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 8U, 0U));
+}
+
+void test_EventCountGet_should_expirePartOfAWrappedRing(void) {
+    for (WEC_TIME_T time = 0U; time <= 50U; time += 10U) {
+        (void) WEC_KeyedTableEventAdd(&table, 3U, time);
+    }
+    // The ring wrapped and holds 20, 30, 40 and 50
+    TEST_ASSERT_EQUAL(KEY_CAPACITY,
+            WEC_KeyedTableEventCountGet(&table, 3U, 50U));
+    TEST_ASSERT_EQUAL(2U, WEC_KeyedTableEventCountGet(&table, 3U, 135U));
+    TEST_ASSERT_EQUAL(1U, WEC_KeyedTableEventCountGet(&table, 3U, 140U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 3U, 145U));
+    TEST_ASSERT_EQUAL(1U, WEC_KeyedTableEventCountGet(&table, 3U, 150U));
+}
+
+void test_EventCountGet_should_evictKey_when_windowHasExpired(void) {
+    (void) WEC_KeyedTableEventAdd(&table, 1U, 10U);
+    (void) WEC_KeyedTableEventAdd(&table, 2U, 50U);
+
+    TEST_ASSERT_EQUAL(0U,
+            WEC_KeyedTableEventCountGet(&table, 1U, WINDOW_LIMIT + 10U));
+    TEST_ASSERT_EQUAL(1U, WEC_KeyedTableKeyCountGet(&table));
+    TEST_ASSERT_EQUAL(1U,
+            WEC_KeyedTableEventCountGet(&table, 2U, WINDOW_LIMIT + 10U));
+}
+
+void test_EventAdd_should_returnTableFull_when_noKeyHasExpired(void) {
+    WEC_KEY_T key;
+    for (key = 0U; key < 12U; key++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, key, 0U));
+    }
+    TEST_ASSERT_EQUAL(WEC_TABLE_FULL, WEC_KeyedTableEventAdd(&table, key, 1U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_KeyedTableEventAdd(&table, 0U, 1U));
+}
+
+void test_EventAdd_should_evictExpiredKeys_when_tableIsFull(void) {
+    WEC_KEY_T key;
+    for (key = 0U; key < 12U; key++) {
+        (void) WEC_KeyedTableEventAdd(&table, key, (key % 2U) ? 0U : 50U);
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_KeyedTableEventAdd(&table, key, WINDOW_LIMIT));
+    for (key = 0U; key < 12U; key++) {
+        WEC_COUNT_T expected = (key % 2U) ? 0U : 1U;
+        TEST_ASSERT_EQUAL(expected,
+                WEC_KeyedTableEventCountGet(&table, key, WINDOW_LIMIT));
+    }
+    TEST_ASSERT_EQUAL(1U, WEC_KeyedTableEventCountGet(&table, key,
+            WINDOW_LIMIT));
+    TEST_ASSERT_EQUAL(7U, WEC_KeyedTableKeyCountGet(&table));
+}
+
+void test_EventAdd_should_sweepForExpiredKeys_when_probeChainHasNone(void) {
+    WEC_KEY_T key;
+    for (key = 0U; key < 11U; key++) {
+        (void) WEC_KeyedTableEventAdd(&table, key, 50U);
+    }
+    (void) WEC_KeyedTableEventAdd(&table, key, 0U);
+
+    // Each call sweeps a few more entries until it reaches the expired key
+    WEC_ERROR_T err = WEC_TABLE_FULL;
+    for (size_t call = 0U; (WEC_TABLE_FULL == err)
+            && (call < (ENTRIES / WEC_KEYED_SWEEP_LENGTH)); call++) {
+        err = WEC_KeyedTableEventAdd(&table, 100U, WINDOW_LIMIT);
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY, err);
+    TEST_ASSERT_EQUAL(12U, WEC_KeyedTableKeyCountGet(&table));
+    TEST_ASSERT_EQUAL(0U,
+            WEC_KeyedTableEventCountGet(&table, 11U, WINDOW_LIMIT));
+    TEST_ASSERT_EQUAL(1U,
+            WEC_KeyedTableEventCountGet(&table, 10U, WINDOW_LIMIT));
+}
+
+void test_EventAdd_should_keepEventsOfEachKey_when_keysShift(void) {
+    // Keys sharing probe sequences move between entries as others leave
+    for (WEC_TIME_T time = 0U; time < 3U; time++) {
+        for (WEC_KEY_T key = 0U; key < 12U; key++) {
+            (void) WEC_KeyedTableEventAdd(&table, key * 977U,
+                    (key < 6U) ? time : (time + 50U));
+        }
+    }
+    TEST_ASSERT_EQUAL(6U, WEC_KeyedTableExpire(&table, WINDOW_LIMIT + 2U));
+    for (WEC_KEY_T key = 6U; key < 12U; key++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY,
+                WEC_KeyedTableEventAdd(&table, key * 977U, 60U));
+        TEST_ASSERT_EQUAL(4U, WEC_KeyedTableEventCountGet(&table, key * 977U,
+                WINDOW_LIMIT + 2U));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_KeyedTableEventAdd(&table, 6U * 977U, 61U));
+    TEST_ASSERT_EQUAL(4U,
+            WEC_KeyedTableEventCountGet(&table, 6U * 977U, 150U));
+    TEST_ASSERT_EQUAL(3U,
+            WEC_KeyedTableEventCountGet(&table, 6U * 977U, 151U));
+}
+
+void test_Expire_should_keepRemainingKeysReachable(void) {
+    // Many keys in a small table force shared probe sequences
+    for (WEC_KEY_T key = 0U; key < 12U; key++) {
+        (void) WEC_KeyedTableEventAdd(&table, key * 977U, key * 10U);
+    }
+
+    TEST_ASSERT_EQUAL(6U, WEC_KeyedTableExpire(&table, WINDOW_LIMIT + 55U));
+    for (WEC_KEY_T key = 0U; key < 12U; key++) {
+        WEC_COUNT_T expected = (key < 6U) ? 0U : 1U;
+        TEST_ASSERT_EQUAL(expected, WEC_KeyedTableEventCountGet(&table,
+                key * 977U, WINDOW_LIMIT + 55U));
+    }
+    TEST_ASSERT_EQUAL(6U, WEC_KeyedTableKeyCountGet(&table));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_entryCountIsNotAPowerOfTwo);
+    RUN_TEST(test_EventCountGet_should_return0_when_keyIsUnknown);
+    RUN_TEST(test_EventAdd_should_countEachKeySeparately);
+    RUN_TEST(test_EventAdd_should_overflowPerKey);
+    RUN_TEST(test_EventCountGet_should_expirePartOfAWrappedRing);
+    RUN_TEST(test_EventCountGet_should_evictKey_when_windowHasExpired);
+    RUN_TEST(test_EventAdd_should_returnTableFull_when_noKeyHasExpired);
+    RUN_TEST(test_EventAdd_should_evictExpiredKeys_when_tableIsFull);
+    RUN_TEST(test_EventAdd_should_sweepForExpiredKeys_when_probeChainHasNone);
+    RUN_TEST(test_EventAdd_should_keepEventsOfEachKey_when_keysShift);
+    RUN_TEST(test_Expire_should_keepRemainingKeysReachable);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+#include "unity.h"
+#include "wec_multi_counter.h"
+
+static WEC_MultiCounter_T counter;
+
+/// Shortest window is exact, the longest uses buckets of 6 units
+static const WEC_TIME_T windowLimits[] = {10U, 100U, 1000U};
+
+#define WINDOW_COUNT (sizeof(windowLimits) / sizeof(windowLimits[0]))
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_MultiCounterInit(&counter, windowLimits, WINDOW_COUNT));
+}
+
+void tearDown(void) {
+    (void) WEC_MultiCounterWindowStop(&counter, 0U);
+}
+
+/// Counts event times in [0, eventCount) that are inside a window at now
+static uint32_t ExactCount(uint32_t eventCount, WEC_TIME_T limit,
+        WEC_TIME_T now) {
+    uint32_t count = 0U;
+    for (uint32_t t = 0U; t < eventCount; t++) {
+        if ((now - t) < limit) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void test_Init_should_returnError_when_windowLimitsAreNotAscending(void) {
+    const WEC_TIME_T descending[] = {100U, 10U};
+    const WEC_TIME_T zero[] = {0U, 10U};
+    const WEC_TIME_T tooMany[WEC_MULTI_LEVELS_MAX + 1U] = {1U, 2U, 3U, 4U, 5U};
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_MultiCounterInit(&counter, descending, 2U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_MultiCounterInit(&counter, zero, 2U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_MultiCounterInit(&counter, tooMany,
+            WEC_MULTI_LEVELS_MAX + 1U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_MultiCounterInit(&counter, windowLimits,
+            0U));
+}
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_MultiCounterEventAdd(&counter, 1U));
+    TEST_ASSERT_EQUAL(0U, WEC_MultiCounterEventCountGet(&counter, 0U, 1U));
+}
+
+void test_EventCountGet_should_countEveryWindow_from_oneStream(void) {
+    (void) WEC_MultiCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T t = 0U; t < 50U; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_MultiCounterEventAdd(&counter, t));
+    }
+    TEST_ASSERT_EQUAL(10U, WEC_MultiCounterEventCountGet(&counter, 0U, 49U));
+    TEST_ASSERT_EQUAL(50U, WEC_MultiCounterEventCountGet(&counter, 1U, 49U));
+    TEST_ASSERT_EQUAL(50U, WEC_MultiCounterEventCountGet(&counter, 2U, 49U));
+}
+
+void test_EventAdd_should_leaveCoarserLevels_until_queried(void) {
+    (void) WEC_MultiCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T t = 0U; t < 5U; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_MultiCounterEventAdd(&counter, t));
+    }
+    TEST_ASSERT_EQUAL(5U, counter.count);
+    TEST_ASSERT_EQUAL(0U, counter.levels[1].total);
+    TEST_ASSERT_EQUAL(0U, counter.levels[2].total);
+
+    TEST_ASSERT_EQUAL(5U, WEC_MultiCounterEventCountGet(&counter, 2U, 5U));
+    TEST_ASSERT_EQUAL(5U, WEC_MultiCounterEventCountGet(&counter, 1U, 5U));
+    TEST_ASSERT_EQUAL(5U, WEC_MultiCounterEventCountGet(&counter, 0U, 5U));
+    TEST_ASSERT_EQUAL(0U, counter.levels[0].unrolled);
+}
+
+void test_EventCountGet_should_stayWithinOneBucket_of_exactCount(void) {
+    (void) WEC_MultiCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T t = 0U; t < 500U; t++) {
+        (void) WEC_MultiCounterEventAdd(&counter, t);
+    }
+    for (WEC_TIME_T now = 499U; now < 1600U; now += 7U) {
+        for (size_t w = 0U; w < WINDOW_COUNT; w++) {
+            uint32_t exact = ExactCount(500U, windowLimits[w], now);
+            uint32_t width = windowLimits[w] / WEC_BUCKET_RESOLUTION + 1U;
+            uint32_t count = WEC_MultiCounterEventCountGet(&counter, w, now);
+            TEST_ASSERT_TRUE(exact <= count);
+            TEST_ASSERT_TRUE(count <= exact + width);
+        }
+    }
+    TEST_ASSERT_EQUAL(0U, WEC_MultiCounterEventCountGet(&counter, 2U, 1600U));
+}
+
+void test_EventCountGet_should_dropAllBuckets_when_idleLongerThanWindow(void) {
+    (void) WEC_MultiCounterWindowStart(&counter, 0U);
+    (void) WEC_MultiCounterEventAdd(&counter, 1U);
+    (void) WEC_MultiCounterEventAdd(&counter, 50U);
+    TEST_ASSERT_EQUAL(2U, WEC_MultiCounterEventCountGet(&counter, 2U, 500U));
+    TEST_ASSERT_EQUAL(0U, WEC_MultiCounterEventCountGet(&counter, 1U, 500U));
+    TEST_ASSERT_EQUAL(0U, WEC_MultiCounterEventCountGet(&counter, 2U, 100000U));
+
+    (void) WEC_MultiCounterEventAdd(&counter, 100001U);
+    for (size_t w = 0U; w < WINDOW_COUNT; w++) {
+        TEST_ASSERT_EQUAL(1U,
+                WEC_MultiCounterEventCountGet(&counter, w, 100001U));
+    }
+}
+
+void test_EventCountGet_should_workAroundTimeOverflow(void) {
+    WEC_TIME_T time = 0U - 35U;
+    (void) WEC_MultiCounterWindowStart(&counter, time);
+    (void) WEC_MultiCounterEventAdd(&counter, time);
+    (void) WEC_MultiCounterEventAdd(&counter, time + 40U);
+    TEST_ASSERT_EQUAL(1U,
+            WEC_MultiCounterEventCountGet(&counter, 0U, time + 40U));
+    TEST_ASSERT_EQUAL(2U,
+            WEC_MultiCounterEventCountGet(&counter, 1U, time + 40U));
+    TEST_ASSERT_EQUAL(2U,
+            WEC_MultiCounterEventCountGet(&counter, 2U, time + 40U));
+}
+
+void test_WindowTimeGet_should_limitEachWindow(void) {
+    (void) WEC_MultiCounterWindowStart(&counter, 100U);
+    TEST_ASSERT_EQUAL(5U, WEC_MultiCounterWindowTimeGet(&counter, 0U, 105U));
+    TEST_ASSERT_EQUAL(10U, WEC_MultiCounterWindowTimeGet(&counter, 0U, 300U));
+    TEST_ASSERT_EQUAL(100U, WEC_MultiCounterWindowTimeGet(&counter, 1U, 300U));
+    TEST_ASSERT_EQUAL(200U, WEC_MultiCounterWindowTimeGet(&counter, 2U, 300U));
+    (void) WEC_MultiCounterWindowStop(&counter, 2000U);
+    TEST_ASSERT_EQUAL(1000U, WEC_MultiCounterWindowTimeGet(&counter, 2U, 5000U));
+    TEST_ASSERT_EQUAL(10U, WEC_MultiCounterWindowLimitGet(&counter, 0U));
+}
+
+void test_WindowStart_should_returnAlreadyStarted_when_started(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_MultiCounterWindowStart(&counter, 0U));
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED,
+            WEC_MultiCounterWindowStart(&counter, 0U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_MultiCounterWindowStop(&counter, 0U));
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED,
+            WEC_MultiCounterWindowStop(&counter, 0U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_windowLimitsAreNotAscending);
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_EventCountGet_should_countEveryWindow_from_oneStream);
+    RUN_TEST(test_EventAdd_should_leaveCoarserLevels_until_queried);
+    RUN_TEST(test_EventCountGet_should_stayWithinOneBucket_of_exactCount);
+    RUN_TEST(test_EventCountGet_should_dropAllBuckets_when_idleLongerThanWindow);
+    RUN_TEST(test_EventCountGet_should_workAroundTimeOverflow);
+    RUN_TEST(test_WindowTimeGet_should_limitEachWindow);
+    RUN_TEST(test_WindowStart_should_returnAlreadyStarted_when_started);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include "unity.h"
+#include "wec_replay.h"
+
+#define LOG_LENGTH (5000U)
+#define CAPACITY (128U)
+
+static WEC_TIME_T eventTimes[LOG_LENGTH];
+static size_t counts[LOG_LENGTH];
+static size_t expected[LOG_LENGTH];
+static WEC_Counter_T reference;
+static WEC_TIME_T referenceBuffer[CAPACITY];
+
+/// Fills the log with random gaps, including repeated times, from start
+static void LogFill(WEC_TIME_T start, uint32_t seed) {
+    WEC_TIME_T now = start;
+    for (size_t i = 0U; i < LOG_LENGTH; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        now += (seed >> 16) % 150U;
+        eventTimes[i] = now;
+    }
+}
+
+/// Starts the online counter that the replay has to agree with
+static void ReferenceStart(WEC_TIME_T windowLimit, WEC_TIME_T start) {
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInit(&reference, referenceBuffer, CAPACITY));
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterWindowLimitSet(&reference, windowLimit));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterWindowStart(&reference, start));
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_EventCounts_should_matchTheOnlineCounter(void) {
+    WEC_TIME_T start = (WEC_TIME_T) 0U - 100000U; // Runs through wrap around
+    LogFill(start, 7U);
+    ReferenceStart(1000U, start);
+    for (size_t i = 0U; i < LOG_LENGTH; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY,
+                WEC_CounterEventAdd(&reference, eventTimes[i]));
+        expected[i] = WEC_CounterEventCountGet(&reference, eventTimes[i]);
+    }
+
+    for (size_t threads = 0U; threads <= 7U; threads++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplayEventCounts(eventTimes, 0U,
+                LOG_LENGTH, 1000U, counts, threads));
+        TEST_ASSERT_EQUAL_MEMORY(expected, counts, sizeof (counts));
+    }
+}
+
+void test_EventCounts_should_expireEvents_when_exactlyWindowLimitOld(void) {
+    const WEC_TIME_T times[] = { 10U, 20U, 20U, 110U, 120U, 125U };
+    const size_t want[] = { 1U, 2U, 3U, 3U, 2U, 3U };
+    size_t got[6];
+
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_ReplayEventCounts(times, 0U, 6U, 100U, got, 1U));
+    TEST_ASSERT_EQUAL_MEMORY(want, got, sizeof (got));
+}
+
+void test_EventCounts_should_countEarlierEvents_when_reportingABlock(void) {
+    LogFill(0U, 11U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplayEventCounts(eventTimes, 0U,
+            LOG_LENGTH, 3000U, expected, 1U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplayEventCounts(eventTimes, 1234U,
+            LOG_LENGTH - 1234U, 3000U, counts, 4U));
+    TEST_ASSERT_EQUAL_MEMORY(&expected[1234],
+            counts, (LOG_LENGTH - 1234U) * sizeof (counts[0]));
+}
+
+void test_EventCounts_should_notCapCounts_when_windowHoldsManyEvents(void) {
+    LogFill(0U, 3U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplayEventCounts(eventTimes, 0U,
+            LOG_LENGTH, (WEC_TIME_T) ~(WEC_TIME_T) 0 / 4U, counts, 3U));
+    for (size_t i = 0U; i < LOG_LENGTH; i++) {
+        TEST_ASSERT_EQUAL(i + 1U, counts[i]);
+    }
+}
+
+void test_EventCounts_should_returnError_when_eventsAreOutOfOrder(void) {
+    const WEC_TIME_T times[] = { 10U, 20U, 15U, 30U };
+    size_t got[4];
+
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ReplayEventCounts(times, 0U, 4U, 100U, got, 2U));
+}
+
+void test_SampleCounts_should_matchTheOnlineCounter(void) {
+    const WEC_TIME_T interval = 37U;
+    const size_t samples = LOG_LENGTH;
+    LogFill(500U, 5U);
+    ReferenceStart(1000U, 0U);
+    size_t next = 0U;
+    for (size_t k = 0U; k < samples; k++) {
+        WEC_TIME_T sampleTime = 100U + ((WEC_TIME_T) k * interval);
+        while ((next < LOG_LENGTH) && (eventTimes[next] <= sampleTime)) {
+            TEST_ASSERT_EQUAL(WEC_OKAY,
+                    WEC_CounterEventAdd(&reference, eventTimes[next]));
+            next++;
+        }
+        expected[k] = WEC_CounterEventCountGet(&reference, sampleTime);
+    }
+
+    for (size_t threads = 1U; threads <= 4U; threads += 3U) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplaySampleCounts(eventTimes,
+                LOG_LENGTH, 1000U, 100U, interval, samples, counts, threads));
+        TEST_ASSERT_EQUAL_MEMORY(expected, counts, samples * sizeof (counts[0]));
+    }
+}
+
+void test_SampleCounts_should_returnError_when_intervalIsZero(void) {
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_ReplaySampleCounts(eventTimes,
+            LOG_LENGTH, 1000U, 0U, 0U, 2U, counts, 1U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_ReplaySampleCounts(eventTimes,
+            LOG_LENGTH, 1000U, 0U, 0U, 1U, counts, 1U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EventCounts_should_matchTheOnlineCounter);
+    RUN_TEST(test_EventCounts_should_expireEvents_when_exactlyWindowLimitOld);
+    RUN_TEST(test_EventCounts_should_countEarlierEvents_when_reportingABlock);
+    RUN_TEST(test_EventCounts_should_notCapCounts_when_windowHoldsManyEvents);
+    RUN_TEST(test_EventCounts_should_returnError_when_eventsAreOutOfOrder);
+    RUN_TEST(test_SampleCounts_should_matchTheOnlineCounter);
+    RUN_TEST(test_SampleCounts_should_returnError_when_intervalIsZero);
+    return UNITY_END();
+}
@@ -0,0 +1,107 @@
+#include "unity.h"
+#include "wec_sharded_counter.h"
+#include <pthread.h>
+
+#define SHARDS (4U)
+#define SHARD_CAPACITY (64U)
+#define WINDOW_LIMIT (1000U)
+
+static WEC_ShardedCounter_T counter;
+static WEC_SpscCounter_T shards[SHARDS];
+static _Alignas(WEC_CACHE_LINE_SIZE)
+WEC_TIME_T buffer[SHARDS * WEC_SHARD_STRIDE(SHARD_CAPACITY)];
+
+void setUp(void) {
+    (void) WEC_ShardedCounterInit(&counter, shards, SHARDS, buffer,
+            SHARD_CAPACITY);
+    (void) WEC_ShardedCounterWindowLimitSet(&counter, WINDOW_LIMIT);
+}
+
+void tearDown(void) {
+    (void) WEC_ShardedCounterWindowStop(&counter, 0U);
+}
+
+static void *Producer(void *argument) {
+    size_t shard = (size_t) (uintptr_t) argument;
+    for (WEC_TIME_T time = 0U; time < SHARD_CAPACITY; time++) {
+        (void) WEC_ShardedCounterEventAdd(&counter, shard, time);
+    }
+    return NULL;
+}
+
+void test_Init_should_returnError_when_storageIsUnusable(void) {
+    WEC_ShardedCounter_T other;
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ShardedCounterInit(&other, NULL, SHARDS, buffer, 64U));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ShardedCounterInit(&other, shards, 0U, buffer, 64U));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_ShardedCounterInit(&other, shards, SHARDS, buffer, 30U));
+}
+
+void test_Shards_should_notShareCacheLines(void) {
+    for (size_t i = 0U; i < SHARDS; i++) {
+        TEST_ASSERT_EQUAL(0U, (uintptr_t) &shards[i] % WEC_CACHE_LINE_SIZE);
+        TEST_ASSERT_EQUAL(0U,
+                (uintptr_t) shards[i].eventBuffer % WEC_CACHE_LINE_SIZE);
+        // The consumer writes the window times of a shard on every query
+        uintptr_t consumerLine =
+                (uintptr_t) &shards[i].startTime / WEC_CACHE_LINE_SIZE;
+        TEST_ASSERT_TRUE(consumerLine
+                != ((uintptr_t) &shards[i].windowLimit / WEC_CACHE_LINE_SIZE));
+    }
+}
+
+void test_EventCountGet_should_sumEveryShard(void) {
+    (void) WEC_ShardedCounterWindowStart(&counter, 0U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 0U, 10U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 1U, 20U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 3U, 30U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 3U, 40U);
+
+    TEST_ASSERT_EQUAL(4U, WEC_ShardedCounterEventCountGet(&counter, 40U));
+    TEST_ASSERT_EQUAL(2U,
+            WEC_ShardedCounterEventCountGet(&counter, WINDOW_LIMIT + 20U));
+    TEST_ASSERT_EQUAL(0U,
+            WEC_ShardedCounterEventCountGet(&counter, WINDOW_LIMIT + 40U));
+}
+
+void test_WindowLimitSet_should_returnAlreadyStarted_when_started(void) {
+    (void) WEC_ShardedCounterWindowStart(&counter, 0U);
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED,
+            WEC_ShardedCounterWindowLimitSet(&counter, 5U));
+    TEST_ASSERT_EQUAL(WINDOW_LIMIT, WEC_ShardedCounterWindowLimitGet(&counter));
+}
+
+void test_EventsClear_should_clearEveryShard(void) {
+    (void) WEC_ShardedCounterWindowStart(&counter, 0U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 0U, 10U);
+    (void) WEC_ShardedCounterEventAdd(&counter, 2U, 10U);
+    WEC_ShardedCounterEventsClear(&counter);
+    TEST_ASSERT_EQUAL(0U, WEC_ShardedCounterEventCountGet(&counter, 10U));
+}
+
+void test_Producers_should_countEveryEvent_when_addingConcurrently(void) {
+    pthread_t producers[SHARDS];
+    (void) WEC_ShardedCounterWindowStart(&counter, 0U);
+    for (size_t i = 0U; i < SHARDS; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&producers[i], NULL, Producer,
+                (void *) (uintptr_t) i));
+    }
+    for (size_t i = 0U; i < SHARDS; i++) {
+        (void) pthread_join(producers[i], NULL);
+    }
+    TEST_ASSERT_EQUAL(SHARDS * SHARD_CAPACITY,
+            WEC_ShardedCounterEventCountGet(&counter, SHARD_CAPACITY));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_storageIsUnusable);
+    RUN_TEST(test_Shards_should_notShareCacheLines);
+    RUN_TEST(test_EventCountGet_should_sumEveryShard);
+    RUN_TEST(test_WindowLimitSet_should_returnAlreadyStarted_when_started);
+    RUN_TEST(test_EventsClear_should_clearEveryShard);
+    RUN_TEST(test_Producers_should_countEveryEvent_when_addingConcurrently);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+#include "unity.h"
+#include "wec_spsc_counter.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define CAPACITY (64U)
+#define WINDOW_LIMIT (32U)
+#define STRESS_EVENTS (200000U)
+
+static WEC_SpscCounter_T counter;
+static WEC_TIME_T buffer[CAPACITY];
+
+/// Number of events the producer has added
+static atomic_uint publishedEvents;
+static atomic_bool producerDone;
+
+void setUp(void) {
+    (void) WEC_SpscCounterInit(&counter, buffer, CAPACITY);
+    (void) WEC_SpscCounterWindowLimitSet(&counter, WINDOW_LIMIT);
+}
+
+void tearDown(void) {
+    (void) WEC_SpscCounterWindowStop(&counter, 0U);
+}
+
+static void *Producer(void *argument) {
+    (void) argument;
+    for (WEC_TIME_T time = 0U; time < STRESS_EVENTS; time++) {
+        while (WEC_OKAY != WEC_SpscCounterEventAdd(&counter, time)) {
+            (void) sched_yield(); // Wait for the consumer to expire events
+        }
+        atomic_store(&publishedEvents, time + 1U);
+    }
+    atomic_store(&producerDone, true);
+    return NULL;
+}
+
+static void *Consumer(void *argument) {
+    bool *failed = argument;
+    while (false == atomic_load(&producerDone)) {
+        (void) sched_yield();
+        WEC_TIME_T published = atomic_load(&publishedEvents);
+        if (0U == published) {
+            continue;
+        }
+        WEC_TIME_T now = published - 1U;
+        WEC_COUNT_T count = WEC_SpscCounterEventCountGet(&counter, now);
+
+        // Every event in (now - WINDOW_LIMIT, now] has been published, and
+        // only events stamped after now can push the count past the window.
+        WEC_COUNT_T minimum = (now < WINDOW_LIMIT) ? now + 1U : WINDOW_LIMIT;
+        if ((count < minimum) || (count > CAPACITY)) {
+            *failed = true;
+        }
+    }
+    return NULL;
+}
+
+void test_Init_should_returnError_when_capacityIsNotAPowerOfTwo(void) {
+    WEC_SpscCounter_T other;
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_SpscCounterInit(&other, buffer, 30U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_SpscCounterInit(&other, buffer, 0U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_SpscCounterInit(&other, NULL, 4U));
+}
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_SpscCounterEventAdd(&counter, 0U));
+}
+
+void test_EventCountGet_should_expireOldEvents(void) {
+    (void) WEC_SpscCounterWindowStart(&counter, 0U);
+    (void) WEC_SpscCounterEventAdd(&counter, 5U);
+    (void) WEC_SpscCounterEventAdd(&counter, 10U);
+
+    TEST_ASSERT_EQUAL(2U, WEC_SpscCounterEventCountGet(&counter, 36U));
+    TEST_ASSERT_EQUAL(1U, WEC_SpscCounterEventCountGet(&counter, 37U));
+    TEST_ASSERT_EQUAL(0U, WEC_SpscCounterEventCountGet(&counter, 42U));
+}
+
+void test_EventCountGet_should_notExpireEventsStampedAfterCurrentTime(void) {
+    (void) WEC_SpscCounterWindowStart(&counter, 0U);
+    (void) WEC_SpscCounterEventAdd(&counter, 5U);
+    (void) WEC_SpscCounterEventAdd(&counter, 100U);
+    TEST_ASSERT_EQUAL(1U, WEC_SpscCounterEventCountGet(&counter, 99U));
+}
+
+void test_EventAdd_should_dropNewEvent_when_bufferIsFull(void) {
+    (void) WEC_SpscCounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T i = 0U; i < CAPACITY; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_SpscCounterEventAdd(&counter, 0U));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_SpscCounterEventAdd(&counter, 1U));
+    TEST_ASSERT_EQUAL(CAPACITY, WEC_SpscCounterEventCountGet(&counter, 1U));
+    TEST_ASSERT_EQUAL(0U, WEC_SpscCounterEventCountGet(&counter, WINDOW_LIMIT));
+}
+
+void test_EventsClear_should_removeAllEvents(void) {
+    (void) WEC_SpscCounterWindowStart(&counter, 0U);
+    (void) WEC_SpscCounterEventAdd(&counter, 1U);
+    WEC_SpscCounterEventsClear(&counter);
+    TEST_ASSERT_EQUAL(0U, WEC_SpscCounterEventCountGet(&counter, 1U));
+}
+
+/// Gets the index of the cache line an address lies in
+static uintptr_t CacheLine(const volatile void *address) {
+    return (uintptr_t) address / WEC_CACHE_LINE_SIZE;
+}
+
+void test_Counter_should_keepConsumerWritesOffProducerLines(void) {
+    uintptr_t consumerLine = CacheLine(&counter.startTime);
+    TEST_ASSERT_EQUAL(consumerLine, CacheLine(&counter.stopTime));
+    TEST_ASSERT_TRUE(consumerLine != CacheLine(&counter.head));
+    TEST_ASSERT_TRUE(consumerLine != CacheLine(&counter.eventBuffer));
+    TEST_ASSERT_TRUE(consumerLine != CacheLine(&counter.started));
+    TEST_ASSERT_TRUE(consumerLine != CacheLine(&counter.windowLimit));
+    TEST_ASSERT_TRUE(CacheLine(&counter.tail) != CacheLine(&counter.head));
+    TEST_ASSERT_TRUE(CacheLine(&counter.tail)
+            != CacheLine(&counter.eventBuffer));
+}
+
+void test_ProducerAndConsumer_should_agreeOnCount_when_runningConcurrently(void) {
+    pthread_t producer;
+    pthread_t consumer;
+    bool failed = false;
+    atomic_store(&publishedEvents, 0U);
+    atomic_store(&producerDone, false);
+    (void) WEC_SpscCounterWindowStart(&counter, 0U);
+
+    TEST_ASSERT_EQUAL(0, pthread_create(&consumer, NULL, Consumer, &failed));
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, Producer, NULL));
+    (void) pthread_join(producer, NULL);
+    (void) pthread_join(consumer, NULL);
+
+    TEST_ASSERT_FALSE(failed);
+    TEST_ASSERT_EQUAL(WINDOW_LIMIT,
+            WEC_SpscCounterEventCountGet(&counter, STRESS_EVENTS - 1U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_capacityIsNotAPowerOfTwo);
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_EventCountGet_should_expireOldEvents);
+    RUN_TEST(test_EventCountGet_should_notExpireEventsStampedAfterCurrentTime);
+    RUN_TEST(test_EventAdd_should_dropNewEvent_when_bufferIsFull);
+    RUN_TEST(test_EventsClear_should_removeAllEvents);
+    RUN_TEST(test_Counter_should_keepConsumerWritesOffProducerLines);
+    RUN_TEST(test_ProducerAndConsumer_should_agreeOnCount_when_runningConcurrently);
+    return UNITY_END();
+}
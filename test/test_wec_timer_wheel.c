@@ -0,0 +1,149 @@
+#include "unity.h"
+#include "wec_timer_wheel.h"
+
+#define COUNTER_COUNT (4U)
+#define BUFFER_SIZE (16U)
+
+static WEC_TimerWheel_T wheel;
+static WEC_Counter_T counters[COUNTER_COUNT];
+static WEC_TIME_T buffers[COUNTER_COUNT][BUFFER_SIZE];
+static WEC_WheelTimer_T timers[COUNTER_COUNT];
+static size_t callbackCount;
+static WEC_COUNT_T callbackCounts[COUNTER_COUNT];
+
+static void CountChanged(WEC_WheelTimer_T *timer, WEC_COUNT_T count,
+        void *context) {
+    TEST_ASSERT_EQUAL_PTR(&wheel, context);
+    callbackCount++;
+    callbackCounts[timer - timers] = count;
+}
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_TimerWheelInit(&wheel, 10U, 0U, CountChanged, &wheel));
+    for (size_t i = 0U; i < COUNTER_COUNT; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY,
+                WEC_CounterInit(&counters[i], buffers[i], BUFFER_SIZE));
+        (void) WEC_CounterWindowLimitSet(&counters[i], 100U);
+        (void) WEC_CounterWindowStart(&counters[i], 0U);
+        WEC_WheelTimerInit(&timers[i], &counters[i]);
+        callbackCounts[i] = 0U;
+    }
+    callbackCount = 0U;
+}
+
+void tearDown(void) {
+}
+
+void test_Init_should_returnError_when_resolutionIsZero(void) {
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_TimerWheelInit(&wheel, 0U, 0U, NULL, NULL));
+}
+
+void test_CounterOldestTimeGet_should_returnTheOldestEvent(void) {
+    WEC_TIME_T oldest = 0U;
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterOldestTimeGet(&counters[0], &oldest));
+    (void) WEC_CounterEventAdd(&counters[0], 5U);
+    (void) WEC_CounterEventAdd(&counters[0], 7U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterOldestTimeGet(&counters[0], &oldest));
+    TEST_ASSERT_EQUAL(5U, oldest);
+}
+
+void test_Advance_should_expireCounters_when_eventsExpire(void) {
+    (void) WEC_CounterEventAdd(&counters[0], 5U);
+    (void) WEC_CounterEventAdd(&counters[0], 25U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 25U);
+
+    TEST_ASSERT_EQUAL(0U, WEC_TimerWheelAdvance(&wheel, 100U));
+    // Oldest event expires at 105, fired on the tick at 110
+    TEST_ASSERT_EQUAL(1U, WEC_TimerWheelAdvance(&wheel, 110U));
+    TEST_ASSERT_EQUAL(1U, callbackCount);
+    TEST_ASSERT_EQUAL(1U, callbackCounts[0]);
+    TEST_ASSERT_EQUAL(0U, WEC_TimerWheelAdvance(&wheel, 120U));
+    TEST_ASSERT_EQUAL(1U, WEC_TimerWheelAdvance(&wheel, 130U));
+    TEST_ASSERT_EQUAL(2U, callbackCount);
+    TEST_ASSERT_EQUAL(0U, callbackCounts[0]);
+    // Nothing left to schedule
+    TEST_ASSERT_EQUAL(0U, WEC_TimerWheelAdvance(&wheel, 1000U));
+}
+
+void test_Advance_should_fireEachCounterOnItsOwnTick(void) {
+    for (size_t i = 0U; i < COUNTER_COUNT; i++) {
+        (void) WEC_CounterEventAdd(&counters[i], (WEC_TIME_T) (i * 20U));
+        WEC_TimerWheelUpdate(&wheel, &timers[i], (WEC_TIME_T) (i * 20U));
+    }
+    for (size_t i = 0U; i < COUNTER_COUNT; i++) {
+        TEST_ASSERT_EQUAL(1U,
+                WEC_TimerWheelAdvance(&wheel, (WEC_TIME_T) (100U + i * 20U)));
+        TEST_ASSERT_EQUAL(0U, callbackCounts[i]);
+        TEST_ASSERT_EQUAL(i + 1U, callbackCount);
+    }
+}
+
+void test_Advance_should_cascade_when_expiryIsManyLapsAway(void) {
+    WEC_TIME_T limit = 10U * WEC_WHEEL_SLOTS * WEC_WHEEL_SLOTS * 3U + 7U;
+    (void) WEC_CounterWindowStop(&counters[0], 0U);
+    (void) WEC_CounterWindowLimitSet(&counters[0], limit);
+    (void) WEC_CounterWindowStart(&counters[0], 0U);
+    (void) WEC_CounterEventAdd(&counters[0], 1U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 1U);
+
+    size_t fired = 0U;
+    WEC_TIME_T t = 0U;
+    while (t < limit) {
+        t += 10U;
+        fired += WEC_TimerWheelAdvance(&wheel, t);
+        if (0U != fired) {
+            break;
+        }
+    }
+    // Fired on the first tick at or after the expiry time
+    TEST_ASSERT_EQUAL(1U, fired);
+    TEST_ASSERT_TRUE(limit + 1U <= t);
+    TEST_ASSERT_TRUE(t < limit + 1U + 10U);
+    TEST_ASSERT_EQUAL(0U, callbackCounts[0]);
+}
+
+void test_Update_should_rescheduleEarlier_when_olderEventArrives(void) {
+    (void) WEC_CounterWindowStop(&counters[0], 0U);
+    (void) WEC_CounterLatenessLimitSet(&counters[0], 50U);
+    (void) WEC_CounterWindowStart(&counters[0], 0U);
+    (void) WEC_CounterEventAdd(&counters[0], 60U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 60U);
+    (void) WEC_CounterEventAdd(&counters[0], 20U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 60U);
+    TEST_ASSERT_EQUAL(1U, WEC_TimerWheelAdvance(&wheel, 120U));
+    TEST_ASSERT_EQUAL(1U, callbackCounts[0]);
+}
+
+void test_Remove_should_stopTheTimer(void) {
+    (void) WEC_CounterEventAdd(&counters[0], 5U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 5U);
+    WEC_TimerWheelRemove(&wheel, &timers[0]);
+    WEC_TimerWheelRemove(&wheel, &timers[0]);
+    TEST_ASSERT_EQUAL(0U, WEC_TimerWheelAdvance(&wheel, 200U));
+    TEST_ASSERT_EQUAL(0U, callbackCount);
+}
+
+void test_Advance_should_notRescheduleStoppedCounters(void) {
+    (void) WEC_CounterEventAdd(&counters[0], 5U);
+    WEC_TimerWheelUpdate(&wheel, &timers[0], 5U);
+    (void) WEC_CounterWindowStop(&counters[0], 50U);
+    TEST_ASSERT_EQUAL(1U, WEC_TimerWheelAdvance(&wheel, 110U));
+    TEST_ASSERT_EQUAL(0U, WEC_TimerWheelAdvance(&wheel, 500U));
+    TEST_ASSERT_EQUAL(0U, callbackCount);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Init_should_returnError_when_resolutionIsZero);
+    RUN_TEST(test_CounterOldestTimeGet_should_returnTheOldestEvent);
+    RUN_TEST(test_Advance_should_expireCounters_when_eventsExpire);
+    RUN_TEST(test_Advance_should_fireEachCounterOnItsOwnTick);
+    RUN_TEST(test_Advance_should_cascade_when_expiryIsManyLapsAway);
+    RUN_TEST(test_Update_should_rescheduleEarlier_when_olderEventArrives);
+    RUN_TEST(test_Remove_should_stopTheTimer);
+    RUN_TEST(test_Advance_should_notRescheduleStoppedCounters);
+    return UNITY_END();
+}
@@ -1,20 +1,56 @@
 
 #include "unity.h"
 #include "windowed_event_counter.h"
+#include <math.h>
 
-extern bool WEC_started;
-extern WEC_TIME_T WEC_startTime;
-extern WEC_TIME_T WEC_stopTime;
-extern WEC_TIME_T WEC_windowLimit;
-extern WEC_TIME_T WEC_eventBuffer[WEC_EVENT_BUFFER_SIZE];
+extern WEC_Counter_T WEC_defaultCounter;
 
-WEC_TIME_T *WEC_PtrIncrement(WEC_TIME_T ptr[]);
+WEC_COUNT_T WEC_IndexIncrement(const WEC_Counter_T *counter, WEC_COUNT_T index);
+
+/// Bump allocator standing in for an application arena
+static struct {
+    WEC_TIME_T memory[256];
+    size_t used;
+    size_t outstanding;
+    bool outOfMemory;
+} arena;
+
+static void *ArenaAllocate(void *context, size_t size) {
+    (void) context;
+    size_t elements = size / sizeof (WEC_TIME_T);
+    if (arena.outOfMemory || (elements > (256U - arena.used))) {
+        return NULL;
+    }
+    void *memory = &arena.memory[arena.used];
+    arena.used += elements;
+    arena.outstanding += size;
+    return memory;
+}
+
+static void ArenaRelease(void *context, void *memory, size_t size) {
+    (void) context;
+    (void) memory;
+    arena.outstanding -= size;
+}
+
+static const WEC_Allocator_T arenaAllocator = {
+    .allocate = ArenaAllocate,
+    .release = ArenaRelease,
+    .context = NULL,
+};
+
+/// Optional features of the counter under test
+static WEC_CounterExtensions_T extensions;
 
 void setUp(void) {
+    arena.used = 0U;
+    arena.outstanding = 0U;
+    arena.outOfMemory = false;
     (void) WEC_WindowStart(0U);
     (void) WEC_WindowStop(0U);
     WEC_EventsClear();
     (void) WEC_WindowLimitSet(10000U);
+    (void) WEC_LatenessLimitSet(0U);
 }
 
 void tearDown(void) {
@@ -180,18 +216,14 @@ void test_EventAdd_should_removeExpiredCounts(void) {
     TEST_ASSERT_EQUAL(2U, WEC_EventCountGet(300U));
 }
 
-void test_PtrIncrement_should_incrementThePointerBy1(void) {
-    WEC_TIME_T *ptr = WEC_eventBuffer;
-    ptr = WEC_PtrIncrement(ptr);
-    TEST_ASSERT_EQUAL_PTR(WEC_eventBuffer + 1, ptr);
+void test_IndexIncrement_should_incrementTheIndexBy1(void) {
+    TEST_ASSERT_EQUAL(1U, WEC_IndexIncrement(&WEC_defaultCounter, 0U));
 }
 
-void test_PtrIncrement_should_wrapAround(void) {
-    WEC_TIME_T *ptr = &WEC_eventBuffer[WEC_EVENT_BUFFER_SIZE - 1];
-    ptr = WEC_PtrIncrement(ptr);
-
-    TEST_ASSERT_EQUAL(0, ptr - WEC_eventBuffer);
-    TEST_ASSERT_EQUAL_PTR(WEC_eventBuffer, ptr);
+void test_IndexIncrement_should_wrapAround(void) {
+    WEC_COUNT_T index = WEC_IndexIncrement(&WEC_defaultCounter,
+            WEC_EVENT_BUFFER_SIZE - 1U);
+    TEST_ASSERT_EQUAL(0U, index % WEC_EVENT_BUFFER_SIZE);
 }
 
 void test_OperationAroundOverflow(void) {
@@ -293,6 +325,946 @@ void test_EventCountGet_should_NotExpireOldEvents_when_NotRunning(void) {
     TEST_ASSERT_EQUAL(2, WEC_EventCountGet(20));
 }
 
+void test_CounterInit_should_leaveCounterStoppedAndEmpty(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[WEC_EVENT_BUFFER_SIZE];
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInit(&counter, buffer, WEC_EVENT_BUFFER_SIZE));
+
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counter, 0U));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterWindowLimitGet(&counter));
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_CounterEventAdd(&counter, 0U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterWindowStart(&counter, 0U));
+}
+
+void test_Counter_should_countIndependentlyOfOtherCounters(void) {
+    WEC_Counter_T counters[2];
+    WEC_TIME_T buffers[2][WEC_EVENT_BUFFER_SIZE];
+    (void) WEC_CounterInit(&counters[0], buffers[0], WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_CounterInit(&counters[1], buffers[1], WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_CounterWindowLimitSet(&counters[0], 10U);
+    (void) WEC_CounterWindowLimitSet(&counters[1], 100U);
+    (void) WEC_CounterWindowStart(&counters[0], 0U);
+    (void) WEC_CounterWindowStart(&counters[1], 0U);
+
+    (void) WEC_CounterEventAdd(&counters[0], 5U);
+    (void) WEC_CounterEventAdd(&counters[1], 5U);
+    (void) WEC_CounterEventAdd(&counters[1], 6U);
+
+    TEST_ASSERT_EQUAL(1U, WEC_CounterEventCountGet(&counters[0], 6U));
+    TEST_ASSERT_EQUAL(2U, WEC_CounterEventCountGet(&counters[1], 6U));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counters[0], 15U));
+    TEST_ASSERT_EQUAL(2U, WEC_CounterEventCountGet(&counters[1], 15U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(15U));
+}
+
+void test_CounterDeinit_should_stopAndClearTheCounter(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[WEC_EVENT_BUFFER_SIZE];
+    (void) WEC_CounterInit(&counter, buffer, WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 1U);
+
+    WEC_CounterDeinit(&counter);
+
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counter, 1U));
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_CounterWindowStop(&counter, 1U));
+}
+
+void test_EventAddBatch_should_returnNotStarted_when_moduleIsNotStarted(void) {
+    WEC_TIME_T times[] = {1U, 2U};
+    size_t overflow = 1U;
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_EventAddBatch(times, 2U, &overflow));
+    TEST_ASSERT_EQUAL(0U, overflow);
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(2U));
+}
+
+void test_EventAddBatch_should_matchIndividualAdds(void) {
+    WEC_TIME_T times[] = {0U, 0U, 3U, 9U, 12U, 15U, 15U, 19U, 25U};
+    size_t n = sizeof (times) / sizeof (times[0]);
+    WEC_Counter_T single;
+    WEC_TIME_T buffer[WEC_EVENT_BUFFER_SIZE];
+    (void) WEC_CounterInit(&single, buffer, WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_CounterWindowLimitSet(&single, 10U);
+    (void) WEC_CounterWindowStart(&single, 0U);
+    (void) WEC_WindowLimitSet(10U);
+    (void) WEC_WindowStart(0U);
+
+    for (size_t i = 0U; i < n; i++) {
+        (void) WEC_CounterEventAdd(&single, times[i]);
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddBatch(times, 4U, NULL));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddBatch(&times[4], n - 4U, NULL));
+
+    for (WEC_TIME_T t = 25U; t < 40U; t++) {
+        TEST_ASSERT_EQUAL(WEC_CounterEventCountGet(&single, t),
+                WEC_EventCountGet(t));
+    }
+}
+
+void test_EventAddBatch_should_wrapAroundTheBuffer(void) {
+    WEC_TIME_T times[WEC_EVENT_BUFFER_SIZE];
+    WEC_TIME_T time;
+    (void) WEC_WindowLimitSet(WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_WindowStart(0U);
+    for (time = 0U; time < (WEC_EVENT_BUFFER_SIZE / 2U); time++) {
+        (void) WEC_EventAdd(time);
+    }
+    for (size_t i = 0U; i < WEC_EVENT_BUFFER_SIZE; i++) {
+        times[i] = time + WEC_EVENT_BUFFER_SIZE;
+    }
+
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_EventAddBatch(times, WEC_EVENT_BUFFER_SIZE, NULL));
+    TEST_ASSERT_EQUAL(WEC_EVENT_BUFFER_SIZE, WEC_EventCountGet(times[0]));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(times[0] + WEC_EVENT_BUFFER_SIZE));
+}
+
+void test_EventAddBatch_should_reportOverflowCount_when_batchDoesNotFit(void) {
+    WEC_TIME_T times[WEC_EVENT_BUFFER_SIZE + 5U];
+    size_t overflow = 0U;
+    WEC_TIME_T limit = WEC_EVENT_BUFFER_SIZE * 2U;
+    (void) WEC_WindowLimitSet(limit);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(0U);
+    (void) WEC_EventAdd(0U);
+    for (size_t i = 0U; i < (WEC_EVENT_BUFFER_SIZE + 5U); i++) {
+        times[i] = (WEC_TIME_T) i + 1U;
+    }
+
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_EventAddBatch(times, WEC_EVENT_BUFFER_SIZE + 5U, &overflow));
+    TEST_ASSERT_EQUAL(7U, overflow);
+    TEST_ASSERT_EQUAL(WEC_EVENT_BUFFER_SIZE, WEC_EventCountGet(limit - 1U));
+    TEST_ASSERT_EQUAL(WEC_EVENT_BUFFER_SIZE - 1U, WEC_EventCountGet(limit + 6U));
+}
+
+void test_EventCountGet_should_expireTheRightNumberOfEvents_when_bufferWraps(void) {
+    WEC_TIME_T time = 0U - (WEC_EVENT_BUFFER_SIZE / 2U);
+    WEC_TIME_T firstTime = time;
+    (void) WEC_WindowLimitSet(WEC_EVENT_BUFFER_SIZE * 2U);
+    (void) WEC_WindowStart(time);
+
+    // Leave the tail in the middle of the buffer before filling it
+    for (WEC_TIME_T i = 0U; i < (WEC_EVENT_BUFFER_SIZE / 2U); i++) {
+        (void) WEC_EventAdd(time - WEC_EVENT_BUFFER_SIZE * 2U);
+    }
+    for (WEC_TIME_T i = 0U; i < WEC_EVENT_BUFFER_SIZE; i++) {
+        (void) WEC_EventAdd(time);
+        time += 2U;
+    }
+
+    for (WEC_TIME_T i = 0U; i <= WEC_EVENT_BUFFER_SIZE; i++) {
+        WEC_TIME_T now = firstTime + (WEC_EVENT_BUFFER_SIZE * 2U) - 1U + (i * 2U);
+        TEST_ASSERT_EQUAL(WEC_EVENT_BUFFER_SIZE - i, WEC_EventCountGet(now));
+    }
+}
+
+void test_EventCountGet_should_expireAllEvents_when_idleLongerThanWindow(void) {
+    (void) WEC_WindowLimitSet(WEC_EVENT_BUFFER_SIZE);
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 0U; time < WEC_EVENT_BUFFER_SIZE; time++) {
+        (void) WEC_EventAdd(time);
+    }
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(1000000U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(1000000U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventCountGet(1000000U));
+}
+
+void test_CounterInit_should_returnError_when_storageIsUnusable(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterInit(&counter, NULL, 4U));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterInit(&counter, buffer, 0U));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            8U, 4U));
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterInitAllocated(&counter, &arenaAllocator, NULL, 4U, 8U));
+}
+
+void test_CounterEventAdd_should_overflowAtTheCallerSuppliedCapacity(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 4U; time++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAdd(&counter, time));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_CounterEventAdd(&counter, 4U));
+    TEST_ASSERT_EQUAL(4U, WEC_CounterEventCountGet(&counter, 4U));
+}
+
+void test_CounterEventAdd_should_growTheBuffer_when_allocated(void) {
+    WEC_Counter_T counter;
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            4U, 8U));
+    (void) WEC_CounterWindowLimitSet(&counter, 2U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+
+    // Leave the events wrapped around the end of the buffer before it grows
+    (void) WEC_CounterEventAdd(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 1U);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAdd(&counter, 2U));
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAdd(&counter, 2U));
+    TEST_ASSERT_EQUAL(8U * sizeof (WEC_TIME_T), arena.outstanding);
+    TEST_ASSERT_EQUAL(5U, WEC_CounterEventCountGet(&counter, 2U));
+    TEST_ASSERT_EQUAL(4U, WEC_CounterEventCountGet(&counter, 3U));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counter, 4U));
+}
+
+void test_CounterEventAdd_should_overflow_when_bufferReachesItsLimit(void) {
+    WEC_Counter_T counter;
+    (void) WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            2U, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 8U; time++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAdd(&counter, time));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_CounterEventAdd(&counter, 8U));
+    TEST_ASSERT_EQUAL(8U, WEC_CounterEventCountGet(&counter, 8U));
+}
+
+void test_CounterEventAdd_should_overflow_when_allocatorIsOutOfMemory(void) {
+    WEC_Counter_T counter;
+    (void) WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            2U, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    arena.outOfMemory = true;
+    (void) WEC_CounterEventAdd(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 1U);
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_CounterEventAdd(&counter, 2U));
+    TEST_ASSERT_EQUAL(2U, WEC_CounterEventCountGet(&counter, 2U));
+}
+
+void test_CounterEventAddBatch_should_growTheBuffer_when_allocated(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T times[6] = {1U, 2U, 3U, 4U, 5U, 6U};
+    size_t overflow = 1U;
+    (void) WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            2U, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 0U);
+
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterEventAddBatch(&counter, times, 6U, &overflow));
+    TEST_ASSERT_EQUAL(0U, overflow);
+    TEST_ASSERT_EQUAL(7U, WEC_CounterEventCountGet(&counter, 6U));
+}
+
+void test_CounterDeinit_should_releaseAllocatedStorage(void) {
+    WEC_Counter_T counter;
+    (void) WEC_CounterInitAllocated(&counter, &arenaAllocator, &extensions,
+            2U, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 5U; time++) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    WEC_CounterDeinit(&counter);
+    TEST_ASSERT_EQUAL(0U, arena.outstanding);
+}
+
+void test_EventSumGet_should_sumWeightsInTheWindow(void) {
+    (void) WEC_WindowLimitSet(10U);
+    (void) WEC_WindowStart(0U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddWeighted(5U, 1500U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAddWeighted(8U, 40U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(9U));
+
+    TEST_ASSERT_EQUAL(3U, WEC_EventCountGet(14U));
+    TEST_ASSERT_EQUAL(1541U, WEC_EventSumGet(14U));
+    TEST_ASSERT_EQUAL(41U, WEC_EventSumGet(15U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventSumGet(18U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventSumGet(19U));
+}
+
+void test_EventSumGet_should_dropTheWeightOfOverflowedEvents(void) {
+    WEC_TIME_T times[2] = {WEC_EVENT_BUFFER_SIZE, WEC_EVENT_BUFFER_SIZE};
+    (void) WEC_WindowLimitSet(WEC_EVENT_BUFFER_SIZE * 2U);
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 0U; time < WEC_EVENT_BUFFER_SIZE; time++) {
+        (void) WEC_EventAddWeighted(time, 100U);
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_EventAddWeighted(WEC_EVENT_BUFFER_SIZE, 7U));
+    TEST_ASSERT_EQUAL((WEC_EVENT_BUFFER_SIZE - 1U) * 100U + 7U,
+            WEC_EventSumGet(WEC_EVENT_BUFFER_SIZE));
+
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_EventAddBatch(times, 2U, NULL));
+    TEST_ASSERT_EQUAL((WEC_EVENT_BUFFER_SIZE - 3U) * 100U + 9U,
+            WEC_EventSumGet(WEC_EVENT_BUFFER_SIZE));
+}
+
+void test_EventSumGet_should_workAroundWeightOverflow(void) {
+    WEC_WEIGHT_T heavy = (WEC_WEIGHT_T) ~(WEC_WEIGHT_T) 0 / 2U;
+    (void) WEC_WindowLimitSet(10U);
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 0U; time < 60U; time += 20U) {
+        (void) WEC_EventAddWeighted(time, heavy);
+        (void) WEC_EventAddWeighted(time + 1U, 3U);
+        TEST_ASSERT_EQUAL(heavy + 3U, WEC_EventSumGet(time + 9U));
+    }
+}
+
+void test_CounterEventAddWeighted_should_returnError_when_notWeighted(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    WEC_WEIGHT_T weights[4];
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterInitWeighted(&counter, buffer, NULL, 4U));
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 1U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterEventAddWeighted(&counter, 1U, 5U));
+    TEST_ASSERT_EQUAL(1U, WEC_CounterEventSumGet(&counter, 1U));
+
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInitWeighted(&counter, buffer, weights, 4U));
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterEventAddWeighted(&counter, 1U, 5U));
+    TEST_ASSERT_EQUAL(5U, WEC_CounterEventSumGet(&counter, 1U));
+}
+
+void test_EventTryAdd_should_admitEvents_when_underTheLimit(void) {
+    WEC_TIME_T wait = 1U;
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_WindowStart(0U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventTryAdd(10U, 2U, &wait));
+    TEST_ASSERT_EQUAL(0U, wait);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventTryAdd(20U, 2U, NULL));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountGet(20U));
+}
+
+void test_EventTryAdd_should_rejectAndReportTheWait_when_atTheLimit(void) {
+    WEC_TIME_T wait = 0U;
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(10U);
+    (void) WEC_EventAdd(20U);
+    (void) WEC_EventAdd(30U);
+
+    TEST_ASSERT_EQUAL(WEC_LIMIT_EXCEEDED, WEC_EventTryAdd(50U, 3U, &wait));
+    TEST_ASSERT_EQUAL(60U, wait);
+    TEST_ASSERT_EQUAL(WEC_LIMIT_EXCEEDED, WEC_EventTryAdd(50U, 2U, &wait));
+    TEST_ASSERT_EQUAL(70U, wait);
+    TEST_ASSERT_EQUAL(3U, WEC_EventCountGet(50U));
+
+    TEST_ASSERT_EQUAL(WEC_LIMIT_EXCEEDED, WEC_EventTryAdd(109U, 3U, &wait));
+    TEST_ASSERT_EQUAL(1U, wait);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventTryAdd(110U, 3U, &wait));
+    TEST_ASSERT_EQUAL(0U, wait);
+}
+
+void test_EventTryAdd_should_returnNotStarted_when_moduleIsNotStarted(void) {
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_EventTryAdd(1U, 1U, NULL));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(1U));
+}
+
+void test_Deserialize_should_restoreASerializedCounter(void) {
+    uint8_t state[WEC_SERIAL_SIZE_MAX(WEC_EVENT_BUFFER_SIZE)];
+    size_t written = 0U;
+    size_t read = 0U;
+    WEC_TIME_T time = 0U - 20U;
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_WindowStart(time);
+    for (WEC_TIME_T i = 0U; i < 5U; i++) {
+        (void) WEC_EventAddWeighted(time + (i * 10U), 1000U + i);
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_Serialize(state, sizeof (state), &written));
+    TEST_ASSERT_TRUE(written
+            < (5U * (sizeof (WEC_TIME_T) + sizeof (WEC_WEIGHT_T))));
+
+    (void) WEC_WindowStop(0U);
+    (void) WEC_WindowLimitSet(7U);
+    WEC_EventsClear();
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_Deserialize(state, written, &read));
+    TEST_ASSERT_EQUAL(written, read);
+    TEST_ASSERT_EQUAL(100U, WEC_WindowLimitGet());
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED, WEC_WindowStart(0U));
+    TEST_ASSERT_EQUAL(5U, WEC_EventCountGet(time + 40U));
+    TEST_ASSERT_EQUAL(5010U, WEC_EventSumGet(time + 40U));
+    TEST_ASSERT_EQUAL(3U, WEC_EventCountGet(time + 110U));
+    TEST_ASSERT_EQUAL(3009U, WEC_EventSumGet(time + 110U));
+}
+
+void test_CounterDeserialize_should_readCountersOneAfterAnother(void) {
+    WEC_Counter_T counters[2];
+    WEC_TIME_T buffers[2][8];
+    uint8_t state[2U * WEC_SERIAL_SIZE_MAX(8U)];
+    size_t length = 0U;
+    size_t offset = 0U;
+    for (int i = 0; i < 2; i++) {
+        (void) WEC_CounterInit(&counters[i], buffers[i], 8U);
+        (void) WEC_CounterWindowLimitSet(&counters[i], 50U);
+        (void) WEC_CounterWindowStart(&counters[i], 0U);
+        for (int j = 0; j <= i; j++) {
+            (void) WEC_CounterEventAdd(&counters[i], 10U);
+        }
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterSerialize(&counters[i],
+                &state[offset], sizeof (state) - offset, &length));
+        offset += length;
+    }
+
+    WEC_Counter_T restored;
+    WEC_TIME_T buffer[8];
+    (void) WEC_CounterInit(&restored, buffer, 8U);
+    size_t end = offset;
+    offset = 0U;
+    for (WEC_COUNT_T i = 1U; i <= 2U; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterDeserialize(&restored,
+                &state[offset], end - offset, &length));
+        TEST_ASSERT_EQUAL(i, WEC_CounterEventCountGet(&restored, 20U));
+        offset += length;
+    }
+    TEST_ASSERT_EQUAL(end, offset);
+}
+
+void test_CounterDeserialize_should_keepNewestEvents_when_capacityIsSmaller(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[8];
+    uint8_t state[WEC_SERIAL_SIZE_MAX(8U)];
+    size_t length = 0U;
+    (void) WEC_CounterInit(&counter, buffer, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 8U; time++) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    (void) WEC_CounterSerialize(&counter, state, sizeof (state), &length);
+
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW,
+            WEC_CounterDeserialize(&counter, state, length, &length));
+    TEST_ASSERT_EQUAL(4U, WEC_CounterEventCountGet(&counter, 8U));
+    TEST_ASSERT_EQUAL(3U, WEC_CounterEventCountGet(&counter, 104U));
+}
+
+void test_CounterDeserialize_should_returnError_when_stateIsUnusable(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    uint8_t state[WEC_SERIAL_SIZE_MAX(4U)];
+    size_t length = 0U;
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 300U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterSerialize(&counter, state, 5U,
+            &length));
+    TEST_ASSERT_EQUAL(0U, length);
+    (void) WEC_CounterSerialize(&counter, state, sizeof (state), &length);
+
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterDeserialize(&counter, state, length - 1U, &length));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountGet(&counter, 300U));
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, WEC_CounterWindowStop(&counter, 300U));
+    state[0]++;
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterDeserialize(&counter, state, sizeof (state), &length));
+    state[0]--;
+    // States from builds with other count or weight widths are rejected
+    state[3]++;
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterDeserialize(&counter, state, sizeof (state), &length));
+    state[3]--;
+    state[4]++;
+    TEST_ASSERT_EQUAL(WEC_ERROR,
+            WEC_CounterDeserialize(&counter, state, sizeof (state), &length));
+    state[4]--;
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterDeserialize(&counter, state, sizeof (state), &length));
+}
+
+void test_EventAdd_should_insertLateEventsInOrder(void) {
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_LatenessLimitSet(20U);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(10U);
+    (void) WEC_EventAdd(30U);
+    (void) WEC_EventAdd(40U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(25U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(20U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(40U));
+
+    TEST_ASSERT_EQUAL(6U, WEC_EventCountGet(109U));
+    TEST_ASSERT_EQUAL(5U, WEC_EventCountGet(110U));
+    TEST_ASSERT_EQUAL(4U, WEC_EventCountGet(120U));
+    TEST_ASSERT_EQUAL(3U, WEC_EventCountGet(125U));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountGet(130U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountGet(140U));
+}
+
+void test_EventAdd_should_rejectEvents_when_laterThanTheLatenessLimit(void) {
+    (void) WEC_WindowLimitSet(100U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_LatenessLimitSet(5U));
+    TEST_ASSERT_EQUAL(5U, WEC_LatenessLimitGet());
+    (void) WEC_WindowStart(0U);
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED, WEC_LatenessLimitSet(6U));
+    (void) WEC_EventAdd(50U);
+
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(45U));
+    TEST_ASSERT_EQUAL(WEC_EVENT_TOO_LATE, WEC_EventAdd(44U));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountGet(50U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventCountGet(145U));
+}
+
+void test_EventTryAdd_should_insertLateEventsInOrder(void) {
+    WEC_TIME_T waitTime = 0U;
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_LatenessLimitSet(20U);
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 50U; time <= 60U; time += 5U) {
+        (void) WEC_EventAdd(time);
+    }
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventTryAdd(55U, 10U, NULL));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountRange(54U, 56U));
+    TEST_ASSERT_EQUAL(WEC_LIMIT_EXCEEDED, WEC_EventTryAdd(52U, 4U, &waitTime));
+    // The first event expires at 150
+    TEST_ASSERT_EQUAL(98U, waitTime);
+    TEST_ASSERT_EQUAL(WEC_EVENT_TOO_LATE, WEC_EventTryAdd(39U, 10U, NULL));
+    TEST_ASSERT_EQUAL(4U, WEC_EventCountGet(60U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventCountGet(155U));
+}
+
+void test_EventAddBatch_should_insertLateEventsInOrder(void) {
+    const WEC_TIME_T late[] = {30U, 45U, 55U, 65U, 70U};
+    size_t overflowCount = 1U;
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_LatenessLimitSet(20U);
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 50U; time <= 60U; time += 5U) {
+        (void) WEC_EventAdd(time);
+    }
+    TEST_ASSERT_EQUAL(WEC_EVENT_TOO_LATE,
+            WEC_EventAddBatch(late, 5U, &overflowCount));
+    TEST_ASSERT_EQUAL(0U, overflowCount);
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountRange(54U, 56U));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountRange(40U, 50U));
+    TEST_ASSERT_EQUAL(7U, WEC_EventCountGet(70U));
+    // Events at 45, 50 and 55 twice have expired
+    TEST_ASSERT_EQUAL(3U, WEC_EventCountGet(155U));
+}
+
+void test_EventAdd_should_countEventsThatLateArrivalAlreadyExpired(void) {
+#if WEC_STATS_ENABLE
+    WEC_Stats_T before;
+    WEC_Stats_T after;
+#endif
+    (void) WEC_WindowLimitSet(10U);
+    (void) WEC_LatenessLimitSet(20U);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(50U);
+#if WEC_STATS_ENABLE
+    WEC_StatsGet(&before);
+#endif
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_EventAdd(35U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventCountGet(50U));
+#if WEC_STATS_ENABLE
+    WEC_StatsGet(&after);
+    TEST_ASSERT_EQUAL(before.adds + 1U, after.adds);
+    TEST_ASSERT_EQUAL(before.expirations + 1U, after.expirations);
+#endif
+}
+
+void test_EventAdd_should_dropTheLateEvent_when_fullAndOlderThanAll(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterLatenessLimitSet(&counter, 50U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 10U; time <= 40U; time += 10U) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_CounterEventAdd(&counter, 5U));
+    TEST_ASSERT_EQUAL(4U, WEC_CounterEventCountGet(&counter, 40U));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountRange(&counter, 4U, 6U));
+    TEST_ASSERT_EQUAL(1U, WEC_CounterEventCountRange(&counter, 9U, 11U));
+
+    // A late event newer than the oldest still replaces it
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, WEC_CounterEventAdd(&counter, 25U));
+    TEST_ASSERT_EQUAL(4U, WEC_CounterEventCountGet(&counter, 40U));
+    TEST_ASSERT_EQUAL(0U, WEC_CounterEventCountRange(&counter, 9U, 11U));
+    TEST_ASSERT_EQUAL(1U, WEC_CounterEventCountRange(&counter, 24U, 26U));
+    TEST_ASSERT_EQUAL(2U, WEC_CounterEventCountGet(&counter, 125U));
+}
+
+void test_EventSumGet_should_includeLateWeights(void) {
+    (void) WEC_WindowLimitSet(100U);
+    (void) WEC_LatenessLimitSet(50U);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAddWeighted(10U, 1U);
+    (void) WEC_EventAddWeighted(30U, 2U);
+    (void) WEC_EventAddWeighted(20U, 4U);
+    (void) WEC_EventAddWeighted(5U, 8U);
+    TEST_ASSERT_EQUAL(15U, WEC_EventSumGet(104U));
+    TEST_ASSERT_EQUAL(7U, WEC_EventSumGet(105U));
+    TEST_ASSERT_EQUAL(6U, WEC_EventSumGet(110U));
+    TEST_ASSERT_EQUAL(2U, WEC_EventSumGet(120U));
+}
+
+/// Records threshold crossings
+static struct {
+    size_t calls;
+    bool above;
+    WEC_COUNT_T count;
+    bool removeSelf;
+} crossings;
+
+static void ThresholdCrossed(WEC_Threshold_T *threshold, bool above,
+        WEC_COUNT_T count, void *context) {
+    crossings.calls++;
+    crossings.above = above;
+    crossings.count = count;
+    if (crossings.removeSelf) {
+        WEC_CounterThresholdRemove((WEC_Counter_T *) context, threshold);
+    }
+}
+
+void test_CounterThresholdAdd_should_notifyCrossingsWithHysteresis(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[8];
+    WEC_Threshold_T threshold;
+    (void) WEC_CounterInit(&counter, buffer, 8U);
+    (void) WEC_CounterExtensionsSet(&counter, &extensions);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    crossings.calls = 0U;
+    crossings.removeSelf = false;
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterThresholdAdd(&counter, &threshold,
+            3U, 1U, ThresholdCrossed, &counter));
+
+    (void) WEC_CounterEventAdd(&counter, 0U);
+    (void) WEC_CounterEventAdd(&counter, 1U);
+    TEST_ASSERT_EQUAL(0U, crossings.calls);
+    (void) WEC_CounterEventAdd(&counter, 2U);
+    TEST_ASSERT_EQUAL(1U, crossings.calls);
+    TEST_ASSERT_TRUE(crossings.above);
+    TEST_ASSERT_EQUAL(3U, crossings.count);
+
+    // Falling to 2 stays within the hysteresis band
+    (void) WEC_CounterEventAdd(&counter, 9U);
+    (void) WEC_CounterEventCountGet(&counter, 11U);
+    TEST_ASSERT_EQUAL(1U, crossings.calls);
+    // Expiry clears the alarm at the moment the count falls to the lower level
+    (void) WEC_CounterEventCountGet(&counter, 12U);
+    TEST_ASSERT_EQUAL(2U, crossings.calls);
+    TEST_ASSERT_FALSE(crossings.above);
+    TEST_ASSERT_EQUAL(1U, crossings.count);
+
+    WEC_CounterThresholdRemove(&counter, &threshold);
+    (void) WEC_CounterEventAdd(&counter, 12U);
+    (void) WEC_CounterEventAdd(&counter, 12U);
+    TEST_ASSERT_EQUAL(2U, crossings.calls);
+}
+
+void test_CounterThresholdAdd_should_returnError_when_levelsAreUnusable(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[8];
+    WEC_Threshold_T threshold;
+    (void) WEC_CounterInit(&counter, buffer, 8U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterThresholdAdd(&counter, &threshold,
+            3U, 1U, ThresholdCrossed, NULL));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterExtensionsSet(&counter, NULL));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterExtensionsSet(&counter, &extensions));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterThresholdAdd(&counter, &threshold,
+            2U, 2U, ThresholdCrossed, NULL));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterThresholdAdd(&counter, &threshold,
+            3U, 1U, NULL, NULL));
+}
+
+void test_CounterExtensionsSet_should_keepAttachedFeatures(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[8];
+    WEC_Threshold_T threshold;
+    WEC_CounterExtensions_T moved;
+    (void) WEC_CounterInit(&counter, buffer, 8U);
+    (void) WEC_CounterExtensionsSet(&counter, &extensions);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    crossings.calls = 0U;
+    crossings.removeSelf = false;
+    (void) WEC_CounterThresholdAdd(&counter, &threshold, 1U, 0U,
+            ThresholdCrossed, &counter);
+
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterExtensionsSet(&counter, &moved));
+    (void) WEC_CounterEventAdd(&counter, 0U);
+    TEST_ASSERT_EQUAL(1U, crossings.calls);
+    TEST_ASSERT_TRUE(crossings.above);
+}
+
+void test_ThresholdAdd_should_letCallbacksRemoveTheirThreshold(void) {
+    WEC_Threshold_T first;
+    WEC_Threshold_T second;
+    crossings.calls = 0U;
+    crossings.removeSelf = true;
+    (void) WEC_WindowStart(0U);
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_ThresholdAdd(&first, 2U, 0U, ThresholdCrossed,
+            &WEC_defaultCounter));
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_ThresholdAdd(&second, 2U, 0U, ThresholdCrossed,
+            &WEC_defaultCounter));
+    (void) WEC_EventAdd(1U);
+    (void) WEC_EventAdd(2U);
+    TEST_ASSERT_EQUAL(2U, crossings.calls);
+    WEC_EventsClear();
+    TEST_ASSERT_EQUAL(2U, crossings.calls);
+    WEC_ThresholdRemove(&first);
+}
+
+void test_EventCountRange_should_countEventsInTheHalfOpenRange(void) {
+    (void) WEC_WindowStart(0U);
+    for (WEC_TIME_T time = 10U; time <= 50U; time += 10U) {
+        (void) WEC_EventAdd(time);
+    }
+    TEST_ASSERT_EQUAL(5U, WEC_EventCountRange(0U, 50U));
+    TEST_ASSERT_EQUAL(4U, WEC_EventCountRange(10U, 50U));
+    TEST_ASSERT_EQUAL(2U, WEC_EventCountRange(15U, 30U));
+    TEST_ASSERT_EQUAL(1U, WEC_EventCountRange(40U, 1000U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountRange(50U, 1000U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountRange(30U, 30U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountRange(30U, 20U));
+    TEST_ASSERT_EQUAL(0U, WEC_EventCountRange(0U, 5U));
+    // Nothing was expired by the queries
+    TEST_ASSERT_EQUAL(5U, WEC_EventCountGet(50U));
+}
+
+void test_CounterEventCountRange_should_matchAScan_when_timesWrap(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[16];
+    (void) WEC_CounterInit(&counter, buffer, 16U);
+    (void) WEC_CounterWindowLimitSet(&counter, 200U);
+    WEC_TIME_T now = (WEC_TIME_T) 0U - 1000U;
+    (void) WEC_CounterWindowStart(&counter, now);
+    uint32_t seed = 11U;
+    for (int i = 0; i < 2000; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        now += (seed >> 16) % 40U;
+        (void) WEC_CounterEventAdd(&counter, now);
+        WEC_TIME_T start = now - (WEC_TIME_T) ((seed >> 4) % 250U);
+        WEC_TIME_T end = start + (WEC_TIME_T) ((seed >> 20) % 120U);
+
+        WEC_COUNT_T expected = 0U;
+        for (WEC_COUNT_T j = 0U; j < counter.count; j++) {
+            WEC_TIME_T event = buffer[(counter.tail + j) % 16U];
+            if (((WEC_TIME_T) (event - start - 1U) < (WEC_TIME_T) (end - start))
+                    && (start != end)) {
+                expected++;
+            }
+        }
+        TEST_ASSERT_EQUAL(expected,
+                WEC_CounterEventCountRange(&counter, start, end));
+    }
+}
+
+/// Checks gap statistics against a scan of the stored events
+static void GapStatsCheck(WEC_Counter_T *counter, WEC_TIME_T currentTime) {
+    WEC_GapStats_T stats;
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterGapStatsGet(counter, currentTime, &stats));
+    TEST_ASSERT_EQUAL(counter->count ? counter->count - 1U : 0U,
+            stats.gapCount);
+    WEC_TIME_T gapMin = 0U;
+    WEC_TIME_T gapMax = 0U;
+    double sum = 0.0;
+    double squareSum = 0.0;
+    for (WEC_COUNT_T i = 1U; i < counter->count; i++) {
+        WEC_TIME_T gap = counter->eventBuffer[(counter->tail + i)
+                % counter->capacity] - counter->eventBuffer[(counter->tail
+                + i - 1U) % counter->capacity];
+        gapMin = ((1U == i) || (gap < gapMin)) ? gap : gapMin;
+        gapMax = ((1U == i) || (gap > gapMax)) ? gap : gapMax;
+        sum += gap;
+        squareSum += (double) gap * gap;
+    }
+    TEST_ASSERT_EQUAL(gapMin, stats.gapMin);
+    TEST_ASSERT_EQUAL(gapMax, stats.gapMax);
+    if (0U < stats.gapCount) {
+        double mean = sum / stats.gapCount;
+        double variance = squareSum / stats.gapCount - mean * mean;
+        TEST_ASSERT_TRUE(fabs(mean - stats.gapMean) < 1e-6);
+        TEST_ASSERT_TRUE(fabs(variance - stats.gapVariance)
+                < 1e-6 * (1.0 + variance));
+    }
+}
+
+void test_CounterGapStatsGet_should_trackGapsAsEventsComeAndGo(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[16];
+    WEC_GapTracker_T tracker;
+    WEC_GapEntry_T minQueue[16];
+    WEC_GapEntry_T maxQueue[16];
+    WEC_GapStats_T stats;
+    (void) WEC_CounterInit(&counter, buffer, 16U);
+    (void) WEC_CounterWindowLimitSet(&counter, 300U);
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterGapStatsGet(&counter, 0U, &stats));
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_CounterGapStatsEnable(&counter, &tracker,
+            minQueue, maxQueue, 16U));
+    (void) WEC_CounterExtensionsSet(&counter, &extensions);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterGapStatsEnable(&counter, &tracker,
+            minQueue, maxQueue, 16U));
+    (void) WEC_CounterWindowStart(&counter, 0U);
+
+    WEC_TIME_T now = 0U;
+    uint32_t seed = 5U;
+    for (int i = 0; i < 3000; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        now += (seed >> 16) % 50U;
+        switch ((seed >> 8) % 8U) {
+        case 0U:
+            GapStatsCheck(&counter, now);
+            break;
+        case 1U: {
+            WEC_TIME_T batch[3] = {now, now + 1U, now + 7U};
+            (void) WEC_CounterEventAddBatch(&counter, batch, 3U, NULL);
+            now += 7U;
+            break;
+        }
+        default:
+            (void) WEC_CounterEventAdd(&counter, now);
+            break;
+        }
+    }
+    GapStatsCheck(&counter, now);
+    WEC_CounterEventsClear(&counter);
+    GapStatsCheck(&counter, now);
+}
+
+void test_GapStatsGet_should_rebuild_when_lateEventsArrive(void) {
+    WEC_GapTracker_T tracker;
+    static WEC_GapEntry_T minQueue[WEC_EVENT_BUFFER_SIZE];
+    static WEC_GapEntry_T maxQueue[WEC_EVENT_BUFFER_SIZE];
+    WEC_GapStats_T stats;
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_GapStatsEnable(&tracker, minQueue,
+            maxQueue, WEC_EVENT_BUFFER_SIZE - 1U));
+    (void) WEC_LatenessLimitSet(100U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_GapStatsEnable(&tracker, minQueue,
+            maxQueue, WEC_EVENT_BUFFER_SIZE));
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(10U);
+    (void) WEC_EventAdd(40U);
+    (void) WEC_EventAdd(20U);
+    (void) WEC_EventAdd(50U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_GapStatsGet(50U, &stats));
+    TEST_ASSERT_EQUAL(3U, stats.gapCount);
+    TEST_ASSERT_EQUAL(10U, stats.gapMin);
+    TEST_ASSERT_EQUAL(20U, stats.gapMax);
+    TEST_ASSERT_TRUE(fabs(stats.gapMean - 40.0 / 3.0) < 1e-9);
+    WEC_GapStatsDisable();
+    TEST_ASSERT_EQUAL(WEC_ERROR, WEC_GapStatsGet(50U, &stats));
+}
+
+#if WEC_STATS_ENABLE
+
+void test_CounterStatsGet_should_countAddsAndOverflows(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    WEC_TIME_T times[3] = {10U, 11U, 12U};
+    WEC_Stats_T stats;
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 5U; time++) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    (void) WEC_CounterEventAddBatch(&counter, times, 3U, NULL);
+
+    WEC_CounterStatsGet(&counter, &stats);
+    TEST_ASSERT_EQUAL(8U, stats.adds);
+    TEST_ASSERT_EQUAL(4U, stats.overflows);
+    TEST_ASSERT_EQUAL(4U, stats.countPeak);
+    TEST_ASSERT_EQUAL(0U, stats.expirations);
+}
+
+void test_CounterDeserialize_should_leaveStatsUnchanged(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    uint8_t state[WEC_SERIAL_SIZE_MAX(4U)];
+    size_t length = 0U;
+    WEC_Stats_T before;
+    WEC_Stats_T after;
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 100U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 3U; time++) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    (void) WEC_CounterSerialize(&counter, state, sizeof (state), &length);
+    WEC_CounterStatsGet(&counter, &before);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY,
+                WEC_CounterDeserialize(&counter, state, length, &length));
+    }
+    WEC_CounterStatsGet(&counter, &after);
+    TEST_ASSERT_EQUAL(before.adds, after.adds);
+    TEST_ASSERT_EQUAL(before.countPeak, after.countPeak);
+    TEST_ASSERT_EQUAL(3U, WEC_CounterEventCountGet(&counter, 3U));
+}
+
+void test_CounterStatsGet_should_trackExpiryBatches(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[8];
+    WEC_Stats_T stats;
+    (void) WEC_CounterInit(&counter, buffer, 8U);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    for (WEC_TIME_T time = 0U; time < 3U; time++) {
+        (void) WEC_CounterEventAdd(&counter, time);
+    }
+    (void) WEC_CounterEventAdd(&counter, 10U);
+    (void) WEC_CounterEventCountGet(&counter, 100U);
+    WEC_CounterEventsClear(&counter);
+
+    WEC_CounterStatsGet(&counter, &stats);
+    TEST_ASSERT_EQUAL(4U, stats.adds);
+    TEST_ASSERT_EQUAL(4U, stats.expirations);
+    TEST_ASSERT_EQUAL(3U, stats.expiryBatchMax);
+    TEST_ASSERT_EQUAL(3U, stats.countPeak);
+}
+
+void test_CounterStatsGet_should_notTruncateLargeExpiryBatches(void) {
+    WEC_Counter_T counter;
+    WEC_TIME_T buffer[4];
+    WEC_TIME_T times[301];
+    WEC_Stats_T stats;
+    for (WEC_TIME_T time = 0U; time < 300U; time++) {
+        times[time] = time;
+    }
+    times[300] = 1000U;
+    (void) WEC_CounterInit(&counter, buffer, 4U);
+    (void) WEC_CounterWindowLimitSet(&counter, 10U);
+    (void) WEC_CounterWindowStart(&counter, 0U);
+    (void) WEC_CounterEventAddBatch(&counter, times, 301U, NULL);
+
+    WEC_CounterStatsGet(&counter, &stats);
+    TEST_ASSERT_EQUAL(300U, stats.expirations);
+    TEST_ASSERT_EQUAL(300U, stats.expiryBatchMax);
+}
+
+void test_StatsGet_should_reportTheDefaultCounter(void) {
+    WEC_Stats_T before;
+    WEC_Stats_T after;
+    WEC_StatsGet(&before);
+    (void) WEC_WindowStart(0U);
+    (void) WEC_EventAdd(1U);
+    WEC_StatsGet(&after);
+    TEST_ASSERT_EQUAL(before.adds + 1U, after.adds);
+}
+
+#endif
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_WindowStart_should_returnOkay_when_moduleIsNotStarted);
@@ -312,8 +1284,8 @@ int main(void) {
     RUN_TEST(test_EventAdd_should_increaseTheEventCount);
     RUN_TEST(test_EventCount_should_startAt0);
     RUN_TEST(test_EventAdd_should_removeExpiredCounts);
-    RUN_TEST(test_PtrIncrement_should_incrementThePointerBy1);
-    RUN_TEST(test_PtrIncrement_should_wrapAround);
+    RUN_TEST(test_IndexIncrement_should_incrementTheIndexBy1);
+    RUN_TEST(test_IndexIncrement_should_wrapAround);
     RUN_TEST(test_OperationAroundOverflow);
     RUN_TEST(test_EventAdd_should_removeExpiredEventsBeforeAddingNewEvents);
     RUN_TEST(test_EventAdd_should_removeOldestEvent_when_addingToFullBuffer);
@@ -321,5 +1293,54 @@ int main(void) {
     RUN_TEST(test_EventAdd_should_returnError_when_moduleIsNotStarted);
     RUN_TEST(test_EventCountGet_should_ExpireOldEvents);
     RUN_TEST(test_EventCountGet_should_NotExpireOldEvents_when_NotRunning);
+    RUN_TEST(test_CounterInit_should_leaveCounterStoppedAndEmpty);
+    RUN_TEST(test_Counter_should_countIndependentlyOfOtherCounters);
+    RUN_TEST(test_CounterDeinit_should_stopAndClearTheCounter);
+    RUN_TEST(test_EventAddBatch_should_returnNotStarted_when_moduleIsNotStarted);
+    RUN_TEST(test_EventAddBatch_should_matchIndividualAdds);
+    RUN_TEST(test_EventAddBatch_should_wrapAroundTheBuffer);
+    RUN_TEST(test_EventAddBatch_should_reportOverflowCount_when_batchDoesNotFit);
+    RUN_TEST(test_EventCountGet_should_expireTheRightNumberOfEvents_when_bufferWraps);
+    RUN_TEST(test_EventCountGet_should_expireAllEvents_when_idleLongerThanWindow);
+    RUN_TEST(test_CounterInit_should_returnError_when_storageIsUnusable);
+    RUN_TEST(test_CounterEventAdd_should_overflowAtTheCallerSuppliedCapacity);
+    RUN_TEST(test_CounterEventAdd_should_growTheBuffer_when_allocated);
+    RUN_TEST(test_CounterEventAdd_should_overflow_when_bufferReachesItsLimit);
+    RUN_TEST(test_CounterEventAdd_should_overflow_when_allocatorIsOutOfMemory);
+    RUN_TEST(test_CounterEventAddBatch_should_growTheBuffer_when_allocated);
+    RUN_TEST(test_CounterDeinit_should_releaseAllocatedStorage);
+    RUN_TEST(test_EventSumGet_should_sumWeightsInTheWindow);
+    RUN_TEST(test_EventSumGet_should_dropTheWeightOfOverflowedEvents);
+    RUN_TEST(test_EventSumGet_should_workAroundWeightOverflow);
+    RUN_TEST(test_CounterEventAddWeighted_should_returnError_when_notWeighted);
+    RUN_TEST(test_EventTryAdd_should_admitEvents_when_underTheLimit);
+    RUN_TEST(test_EventTryAdd_should_rejectAndReportTheWait_when_atTheLimit);
+    RUN_TEST(test_EventTryAdd_should_returnNotStarted_when_moduleIsNotStarted);
+    RUN_TEST(test_Deserialize_should_restoreASerializedCounter);
+    RUN_TEST(test_CounterDeserialize_should_readCountersOneAfterAnother);
+    RUN_TEST(test_CounterDeserialize_should_keepNewestEvents_when_capacityIsSmaller);
+    RUN_TEST(test_CounterDeserialize_should_returnError_when_stateIsUnusable);
+    RUN_TEST(test_EventAdd_should_insertLateEventsInOrder);
+    RUN_TEST(test_EventAdd_should_rejectEvents_when_laterThanTheLatenessLimit);
+    RUN_TEST(test_EventTryAdd_should_insertLateEventsInOrder);
+    RUN_TEST(test_EventAddBatch_should_insertLateEventsInOrder);
+    RUN_TEST(test_EventAdd_should_countEventsThatLateArrivalAlreadyExpired);
+    RUN_TEST(test_EventAdd_should_dropTheLateEvent_when_fullAndOlderThanAll);
+    RUN_TEST(test_EventSumGet_should_includeLateWeights);
+    RUN_TEST(test_CounterThresholdAdd_should_notifyCrossingsWithHysteresis);
+    RUN_TEST(test_CounterThresholdAdd_should_returnError_when_levelsAreUnusable);
+    RUN_TEST(test_CounterExtensionsSet_should_keepAttachedFeatures);
+    RUN_TEST(test_ThresholdAdd_should_letCallbacksRemoveTheirThreshold);
+    RUN_TEST(test_EventCountRange_should_countEventsInTheHalfOpenRange);
+    RUN_TEST(test_CounterEventCountRange_should_matchAScan_when_timesWrap);
+    RUN_TEST(test_CounterGapStatsGet_should_trackGapsAsEventsComeAndGo);
+    RUN_TEST(test_GapStatsGet_should_rebuild_when_lateEventsArrive);
+#if WEC_STATS_ENABLE
+    RUN_TEST(test_CounterStatsGet_should_countAddsAndOverflows);
+    RUN_TEST(test_CounterDeserialize_should_leaveStatsUnchanged);
+    RUN_TEST(test_CounterStatsGet_should_trackExpiryBatches);
+    RUN_TEST(test_CounterStatsGet_should_notTruncateLargeExpiryBatches);
+    RUN_TEST(test_StatsGet_should_reportTheDefaultCounter);
+#endif
     return UNITY_END();
 }
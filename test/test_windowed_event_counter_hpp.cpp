@@ -0,0 +1,212 @@
+#include "unity.h"
+#include "windowed_event_counter.h"
+#include "windowed_event_counter.hpp"
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define CAPACITY (16U)
+
+using Counter = wec::windowed_event_counter<CAPACITY, WEC_TIME_T, WEC_COUNT_T>;
+using Rejecting = wec::windowed_event_counter<CAPACITY, WEC_TIME_T,
+        WEC_COUNT_T, wec::overflow_policy::reject>;
+using Growing = wec::windowed_event_counter<12U, WEC_TIME_T, WEC_COUNT_T,
+        wec::overflow_policy::grow>;
+
+static_assert(std::is_nothrow_move_constructible_v<Counter>);
+static_assert(std::is_nothrow_move_assignable_v<Counter>);
+static_assert(std::is_nothrow_move_constructible_v<Growing>);
+static_assert(std::is_nothrow_move_assignable_v<Growing>);
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/// Runs the same random events through a template counter and a C counter
+template <std::size_t Capacity>
+static void CompareWithC(uint32_t seed) {
+    static WEC_Counter_T reference;
+    static WEC_TIME_T buffer[Capacity];
+    wec::windowed_event_counter<Capacity, WEC_TIME_T, WEC_COUNT_T> counter;
+    TEST_ASSERT_EQUAL(WEC_OKAY,
+            WEC_CounterInit(&reference, buffer, Capacity));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterWindowLimitSet(&reference, 50U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, counter.window_limit_set(50U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, WEC_CounterWindowStart(&reference, 7U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, counter.window_start(7U));
+
+    WEC_TIME_T now = 7U;
+    for (int i = 0; i < 20000; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        now = static_cast<WEC_TIME_T>(now + ((seed >> 16) % 8U));
+        if (0U == ((seed >> 8) % 4U)) {
+            TEST_ASSERT_EQUAL(WEC_CounterEventCountGet(&reference, now),
+                    counter.event_count_get(now));
+        } else {
+            TEST_ASSERT_EQUAL(WEC_CounterEventAdd(&reference, now),
+                    counter.event_add(now));
+        }
+        TEST_ASSERT_EQUAL(WEC_CounterWindowTimeGet(&reference, now),
+                counter.window_time_get(now));
+    }
+    TEST_ASSERT_EQUAL(WEC_CounterWindowStop(&reference, now),
+            counter.window_stop(now));
+    TEST_ASSERT_EQUAL(WEC_CounterWindowTimeGet(&reference, now + 5U),
+            counter.window_time_get(now + 5U));
+}
+
+void test_EventAdd_should_matchCCounter_when_capacityIsPowerOfTwo(void) {
+    CompareWithC<16U>(1U);
+}
+
+#if !WEC_EVENT_BUFFER_MASKED
+void test_EventAdd_should_matchCCounter_when_capacityIsNotPowerOfTwo(void) {
+    CompareWithC<30U>(2U);
+}
+#endif
+
+void test_EventAdd_should_returnNotStarted_when_notStarted(void) {
+    Counter counter;
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, counter.event_add(1U));
+    TEST_ASSERT_EQUAL(0U, counter.event_count_get(1U));
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, counter.window_stop(1U));
+}
+
+void test_WindowLimitSet_should_fail_when_started(void) {
+    Counter counter;
+    TEST_ASSERT_EQUAL(WEC_OKAY, counter.window_limit_set(10U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, counter.window_start(0U));
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED, counter.window_start(0U));
+    TEST_ASSERT_EQUAL(WEC_ALREADY_STARTED, counter.window_limit_set(20U));
+    TEST_ASSERT_EQUAL(10U, counter.window_limit_get());
+}
+
+void test_EventAdd_should_keepStoredEvents_when_rejectingOverflow(void) {
+    Rejecting counter;
+    (void) counter.window_limit_set(100U);
+    (void) counter.window_start(0U);
+    for (WEC_TIME_T t = 0U; t < CAPACITY; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, counter.event_add(t));
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, counter.event_add(CAPACITY));
+    TEST_ASSERT_EQUAL(CAPACITY, counter.event_count_get(CAPACITY));
+    // The oldest stored event still expires first
+    TEST_ASSERT_EQUAL(CAPACITY - 1U, counter.event_count_get(100U));
+    TEST_ASSERT_EQUAL(WEC_OKAY, counter.event_add(100U));
+}
+
+void test_EventAdd_should_dropOldest_when_overflowing(void) {
+    Counter counter;
+    (void) counter.window_limit_set(100U);
+    (void) counter.window_start(0U);
+    for (WEC_TIME_T t = 0U; t < CAPACITY; t++) {
+        (void) counter.event_add(t);
+    }
+    TEST_ASSERT_EQUAL(WEC_BUFFER_OVERFLOW, counter.event_add(CAPACITY));
+    TEST_ASSERT_EQUAL(CAPACITY, counter.event_count_get(CAPACITY));
+    TEST_ASSERT_EQUAL(CAPACITY - 1U, counter.event_count_get(101U));
+}
+
+void test_EventAdd_should_growBuffer_when_growing(void) {
+    Growing counter;
+    (void) counter.window_limit_set(1000U);
+    (void) counter.window_start(0U);
+    TEST_ASSERT_EQUAL(12U, counter.capacity());
+    // Wrap the indices before growing
+    for (WEC_TIME_T t = 0U; t < 8U; t++) {
+        (void) counter.event_add(t);
+    }
+    TEST_ASSERT_EQUAL(0U, counter.event_count_get(1007U));
+    for (WEC_TIME_T t = 1007U; t < 1047U; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, counter.event_add(t));
+    }
+    TEST_ASSERT_EQUAL(48U, counter.capacity());
+    TEST_ASSERT_EQUAL(40U, counter.event_count_get(1047U));
+    TEST_ASSERT_EQUAL(29U, counter.event_count_get(2017U));
+    TEST_ASSERT_EQUAL(0U, counter.event_count_get(2047U));
+}
+
+void test_Counter_should_keepEvents_when_moved(void) {
+    std::vector<Growing> counters(1);
+    (void) counters[0].window_limit_set(100U);
+    (void) counters[0].window_start(0U);
+    for (WEC_TIME_T t = 0U; t < 20U; t++) {
+        (void) counters[0].event_add(t);
+    }
+    counters.resize(8); // Reallocates, moving the first counter
+    TEST_ASSERT_EQUAL(20U, counters[0].event_count_get(20U));
+    TEST_ASSERT_EQUAL(0U, counters[7].event_count_get(20U));
+
+    Growing moved = std::move(counters[0]);
+    TEST_ASSERT_EQUAL(9U, moved.event_count_get(110U));
+}
+
+void test_Counter_should_beUsable_when_movedFrom(void) {
+    Growing source;
+    (void) source.window_limit_set(100U);
+    (void) source.window_start(0U);
+    for (WEC_TIME_T t = 0U; t < 20U; t++) {
+        (void) source.event_add(t);
+    }
+    Growing target(std::move(source));
+    TEST_ASSERT_EQUAL(20U, target.event_count_get(20U));
+
+    // The source is left stopped and empty, and can be started again
+    TEST_ASSERT_EQUAL(0U, source.event_count_get(20U));
+    TEST_ASSERT_EQUAL(0U, source.window_limit_get());
+    TEST_ASSERT_EQUAL(WEC_NOT_STARTED, source.event_add(20U));
+    (void) source.window_limit_set(100U);
+    (void) source.window_start(20U);
+    for (WEC_TIME_T t = 20U; t < 50U; t++) {
+        TEST_ASSERT_EQUAL(WEC_OKAY, source.event_add(t));
+    }
+    TEST_ASSERT_EQUAL(48U, source.capacity());
+    TEST_ASSERT_EQUAL(30U, source.event_count_get(49U));
+
+    target = std::move(source);
+    TEST_ASSERT_EQUAL(24U, target.event_count_get(125U));
+    TEST_ASSERT_EQUAL(0U, source.event_count_get(54U));
+    (void) source.window_limit_set(10U);
+    (void) source.window_start(0U);
+    TEST_ASSERT_EQUAL(WEC_OKAY, source.event_add(1U));
+    TEST_ASSERT_EQUAL(1U, source.event_count_get(1U));
+
+    Counter fixed;
+    (void) fixed.window_limit_set(10U);
+    (void) fixed.window_start(0U);
+    (void) fixed.event_add(1U);
+    Counter fixedTarget(std::move(fixed));
+    TEST_ASSERT_EQUAL(1U, fixedTarget.event_count_get(2U));
+    TEST_ASSERT_EQUAL(0U, fixed.event_count_get(2U));
+}
+
+void test_Counter_should_count_when_usingWideTypes(void) {
+    wec::windowed_event_counter<4096U, uint64_t, uint32_t> counter;
+    (void) counter.window_limit_set(10000U);
+    (void) counter.window_start(UINT64_MAX - 5000U);
+    for (uint64_t t = UINT64_MAX - 5000U; t != 5000U; t++) {
+        (void) counter.event_add(t);
+    }
+    // Only the newest 4096 events fit
+    TEST_ASSERT_EQUAL(4096U, counter.event_count_get(5000U));
+    TEST_ASSERT_EQUAL(999U, counter.event_count_get(14000U));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_EventAdd_should_matchCCounter_when_capacityIsPowerOfTwo);
+#if !WEC_EVENT_BUFFER_MASKED
+    RUN_TEST(test_EventAdd_should_matchCCounter_when_capacityIsNotPowerOfTwo);
+#endif
+    RUN_TEST(test_EventAdd_should_returnNotStarted_when_notStarted);
+    RUN_TEST(test_WindowLimitSet_should_fail_when_started);
+    RUN_TEST(test_EventAdd_should_keepStoredEvents_when_rejectingOverflow);
+    RUN_TEST(test_EventAdd_should_dropOldest_when_overflowing);
+    RUN_TEST(test_EventAdd_should_growBuffer_when_growing);
+    RUN_TEST(test_Counter_should_keepEvents_when_moved);
+    RUN_TEST(test_Counter_should_beUsable_when_movedFrom);
+    RUN_TEST(test_Counter_should_count_when_usingWideTypes);
+    return UNITY_END();
+}
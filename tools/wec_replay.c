@@ -0,0 +1,280 @@
+/**
+ * @file
+ * wec_replay.c
+ *
+ * @author
+ * D. Ryan Bartling
+ *
+ * @brief
+ * Replays a recorded log of event times and prints the window counts.
+ *
+ * The log is memory mapped and counted a block at a time across every core.
+ * Binary logs hold native WEC_TIME_T values and are counted in place; text
+ * logs hold one decimal time per line and are parsed into memory first.  Each
+ * output line holds a time and the count of events in the window at that
+ * time, either after every event or at evenly spaced samples.
+ *
+ * Usage: wec_replay -w windowLimit [-t] [-j threads]
+ *                   [-s sampleStart -i sampleInterval -n sampleCount] file
+ */
+
+/*******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 D. Ryan Bartling
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+//
+// Section: Included Files
+//
+
+#include "wec_replay.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//
+// Section: Constants
+//
+
+/// Events or samples counted between writes of the output
+#define REPLAY_BLOCK (1U << 20)
+
+//
+// Section: Data Types
+//
+
+typedef struct {
+    WEC_TIME_T windowLimit;
+    bool text;
+    size_t threads;
+    bool sampled;
+    WEC_TIME_T sampleStart;
+    WEC_TIME_T sampleInterval;
+    size_t sampleCount;
+    const char *path;
+} ReplayOptions_T;
+
+//
+// Section: Static Function Definitions
+//
+
+static bool ReplayOptionsParse(int argc, char *argv[],
+        ReplayOptions_T *options) {
+    bool limitGiven = false;
+    unsigned samplePartsGiven = 0U;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    memset(options, 0, sizeof (*options));
+    options->threads = (0 < cores) ? (size_t) cores : 1U;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1) < argc;
+        if (0 == strcmp(argv[i], "-t")) {
+            options->text = true;
+        } else if ((0 == strcmp(argv[i], "-w")) && hasValue) {
+            options->windowLimit = (WEC_TIME_T) strtoull(argv[++i], NULL, 10);
+            limitGiven = true;
+        } else if ((0 == strcmp(argv[i], "-j")) && hasValue) {
+            options->threads = strtoul(argv[++i], NULL, 10);
+        } else if ((0 == strcmp(argv[i], "-s")) && hasValue) {
+            options->sampleStart = (WEC_TIME_T) strtoull(argv[++i], NULL, 10);
+            samplePartsGiven |= 1U;
+        } else if ((0 == strcmp(argv[i], "-i")) && hasValue) {
+            options->sampleInterval =
+                    (WEC_TIME_T) strtoull(argv[++i], NULL, 10);
+            samplePartsGiven |= 2U;
+        } else if ((0 == strcmp(argv[i], "-n")) && hasValue) {
+            options->sampleCount = strtoul(argv[++i], NULL, 10);
+            samplePartsGiven |= 4U;
+        } else if ((NULL == options->path) && ('-' != argv[i][0])) {
+            options->path = argv[i];
+        } else {
+            return false;
+        }
+    }
+    options->sampled = (0U != samplePartsGiven);
+
+    return limitGiven && (NULL != options->path)
+            && ((0U == samplePartsGiven) || (7U == samplePartsGiven));
+}
+
+/// Parses one decimal time per line, skipping blank lines
+static WEC_TIME_T *ReplayTextParse(const char *text, size_t length,
+        size_t *eventCount) {
+    size_t capacity = 1024U;
+    size_t count = 0U;
+    WEC_TIME_T *times = malloc(capacity * sizeof (WEC_TIME_T));
+    size_t position = 0U;
+
+    while (NULL != times) {
+        while ((position < length)
+                && ((text[position] < '0') || (text[position] > '9'))) {
+            position++;
+        }
+        if (position >= length) {
+            break;
+        }
+        WEC_TIME_T time = 0U;
+        while ((position < length) && (text[position] >= '0')
+                && (text[position] <= '9')) {
+            time = (WEC_TIME_T) ((time * 10U)
+                    + (WEC_TIME_T) (text[position] - '0'));
+            position++;
+        }
+        if (count == capacity) {
+            WEC_TIME_T *grown = realloc(times,
+                    2U * capacity * sizeof (WEC_TIME_T));
+            if (NULL == grown) {
+                free(times);
+                return NULL;
+            }
+            times = grown;
+            capacity *= 2U;
+        }
+        times[count++] = time;
+    }
+    *eventCount = count;
+
+    return times;
+}
+
+static bool ReplayEvents(const WEC_TIME_T times[], size_t eventCount,
+        const ReplayOptions_T *options, size_t counts[]) {
+    bool ordered = true;
+
+    for (size_t first = 0U; first < eventCount; first += REPLAY_BLOCK) {
+        size_t length = eventCount - first;
+        length = (length > REPLAY_BLOCK) ? REPLAY_BLOCK : length;
+        if (WEC_OKAY != WEC_ReplayEventCounts(times, first, length,
+                options->windowLimit, counts, options->threads)) {
+            ordered = false;
+        }
+        for (size_t i = 0U; i < length; i++) {
+            printf("%llu %zu\n", (unsigned long long) times[first + i],
+                    counts[i]);
+        }
+    }
+
+    return ordered;
+}
+
+static bool ReplaySamples(const WEC_TIME_T times[], size_t eventCount,
+        const ReplayOptions_T *options, size_t counts[]) {
+    for (size_t first = 0U; first < options->sampleCount;
+            first += REPLAY_BLOCK) {
+        size_t length = options->sampleCount - first;
+        length = (length > REPLAY_BLOCK) ? REPLAY_BLOCK : length;
+        WEC_TIME_T start = (WEC_TIME_T) (options->sampleStart
+                + ((WEC_TIME_T) first * options->sampleInterval));
+        if (WEC_OKAY != WEC_ReplaySampleCounts(times, eventCount,
+                options->windowLimit, start, options->sampleInterval, length,
+                counts, options->threads)) {
+            return false;
+        }
+        for (size_t i = 0U; i < length; i++) {
+            printf("%llu %zu\n", (unsigned long long) (WEC_TIME_T) (start
+                    + ((WEC_TIME_T) i * options->sampleInterval)), counts[i]);
+        }
+    }
+
+    return true;
+}
+
+//
+// Section: Main
+//
+
+int main(int argc, char *argv[]) {
+    ReplayOptions_T options;
+    if (false == ReplayOptionsParse(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s -w windowLimit [-t] [-j threads] "
+                "[-s sampleStart -i sampleInterval -n sampleCount] file\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(options.path, O_RDONLY);
+    struct stat status;
+    if ((0 > fd) || (0 != fstat(fd, &status))) {
+        perror(options.path);
+        return EXIT_FAILURE;
+    }
+    size_t fileSize = (size_t) status.st_size;
+    void *mapped = NULL;
+    if (0U < fileSize) {
+        mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == mapped) {
+            perror(options.path);
+            return EXIT_FAILURE;
+        }
+        (void) madvise(mapped, fileSize, MADV_SEQUENTIAL);
+    }
+    (void) close(fd);
+
+    const WEC_TIME_T *times = mapped;
+    WEC_TIME_T *parsed = NULL;
+    size_t eventCount = fileSize / sizeof (WEC_TIME_T);
+    if (options.text) {
+        parsed = ReplayTextParse(mapped, fileSize, &eventCount);
+        times = parsed;
+    } else if (0U != (fileSize % sizeof (WEC_TIME_T))) {
+        fprintf(stderr, "%s: size is not a multiple of %zu bytes\n",
+                options.path, sizeof (WEC_TIME_T));
+        return EXIT_FAILURE;
+    }
+    size_t *counts = malloc(REPLAY_BLOCK * sizeof (size_t));
+    if ((NULL == counts) || (options.text && (NULL == parsed))) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    static char output[1U << 16];
+    (void) setvbuf(stdout, output, _IOFBF, sizeof (output));
+    bool okay = options.sampled
+            ? ReplaySamples(times, eventCount, &options, counts)
+            : ReplayEvents(times, eventCount, &options, counts);
+    (void) fflush(stdout);
+    if (false == okay) {
+        fprintf(stderr, "%s: %s\n", options.path, options.sampled
+                ? "sample interval is 0"
+                : "events are out of order, counts are not meaningful");
+    }
+
+    free(counts);
+    free(parsed);
+    if (NULL != mapped) {
+        (void) munmap(mapped, fileSize);
+    }
+
+    return okay ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//
+// End of File
+//
+